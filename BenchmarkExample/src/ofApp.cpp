@@ -0,0 +1,724 @@
+#include "ofMain.h"
+#include "ofxOsc.h"
+#include "ofxOscRecorder.h"
+#include "ofxRecordOscAddressFilter.h"
+#include "ofxRecordedOscPlayer.h"
+#include "ofxRecordOscTrack.h"
+#include "ofxRecordOscSequenceReader.h"
+
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// headless benchmarks. run binary and read result in console.
+
+#pragma mark heap usage
+
+// global new / delete are replaced to measure peak heap usage of loading
+namespace {
+    struct heap_usage {
+        static std::atomic<std::size_t> &current() {
+            static std::atomic<std::size_t> bytes{0};
+            return bytes;
+        }
+        static std::atomic<std::size_t> &peak() {
+            static std::atomic<std::size_t> bytes{0};
+            return bytes;
+        }
+
+        static void add(std::size_t size) {
+            auto now = current().fetch_add(size, std::memory_order_relaxed) + size;
+            auto max = peak().load(std::memory_order_relaxed);
+            while(max < now && !peak().compare_exchange_weak(max, now, std::memory_order_relaxed)) {}
+        }
+        static void sub(std::size_t size)
+        { current().fetch_sub(size, std::memory_order_relaxed); };
+
+        // returns current usage as baseline of next peak
+        static std::size_t resetPeak() {
+            auto now = current().load(std::memory_order_relaxed);
+            peak().store(now, std::memory_order_relaxed);
+            return now;
+        }
+    };
+
+    // size is kept in front of block
+    constexpr std::size_t heap_header_size = alignof(std::max_align_t);
+};
+
+void *operator new(std::size_t size) {
+    auto p = static_cast<std::uint8_t *>(std::malloc(size + heap_header_size));
+    if(p == nullptr) throw std::bad_alloc();
+    *reinterpret_cast<std::size_t *>(p) = size;
+    heap_usage::add(size);
+    return p + heap_header_size;
+}
+
+void operator delete(void *ptr) noexcept {
+    if(ptr == nullptr) return;
+    auto p = static_cast<std::uint8_t *>(ptr) - heap_header_size;
+    heap_usage::sub(*reinterpret_cast<std::size_t *>(p));
+    std::free(p);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{ operator delete(ptr); }
+
+namespace {
+    using bench_clock = std::chrono::steady_clock;
+
+    template <typename function_t>
+    double measure_ns_per_op(std::size_t num_ops, function_t f) {
+        auto start = bench_clock::now();
+        f();
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock::now() - start).count();
+        return static_cast<double>(elapsed) / num_ops;
+    }
+
+    template <typename function_t>
+    double measure_ms(function_t f)
+    { return measure_ns_per_op(1000000, f); }
+
+#pragma mark address filter
+
+    void benchmark_address_filter() {
+        // typical traffic: many sensors, debug messages mixed in
+        std::vector<std::string> addresses;
+        for(int i = 0; i < 64; ++i) {
+            addresses.push_back(ofVAArgsToString("/sensor/%d/accel", i));
+            addresses.push_back(ofVAArgsToString("/sensor/%d/gyro", i));
+            addresses.push_back(ofVAArgsToString("/sensor/%d/debug", i));
+        }
+        addresses.push_back("/note/on");
+        addresses.push_back("/note/off");
+        addresses.push_back("/ping");
+
+        const std::size_t num_messages = 10 * 1000 * 1000;
+        std::size_t num_allowed = 0;
+
+        // exact lookup with std::set, same as previous is_allow
+        std::set<std::string> exact_blacklists;
+        for(int i = 0; i < 64; ++i) exact_blacklists.insert(ofVAArgsToString("/sensor/%d/debug", i));
+        exact_blacklists.insert("/ping");
+        auto exact = measure_ns_per_op(num_messages, [&] {
+            for(std::size_t i = 0; i < num_messages; ++i) {
+                const auto &address = addresses[i % addresses.size()];
+                if(exact_blacklists.find(address) == exact_blacklists.end()) ++num_allowed;
+            }
+        });
+
+        ofxRecordOscAddressFilter filter;
+        filter.setup({"/sensor/*/{accel,gyro,debug}", "/note/*", "/ping"},
+                     {"/sensor/*/debug", "/ping"});
+        auto uncached = measure_ns_per_op(num_messages, [&] {
+            for(std::size_t i = 0; i < num_messages; ++i) {
+                if(filter.isAllowed(addresses[i % addresses.size()])) ++num_allowed;
+            }
+        });
+
+        ofxRecordOscAddressFilter::Cache cache;
+        auto cached = measure_ns_per_op(num_messages, [&] {
+            for(std::size_t i = 0; i < num_messages; ++i) {
+                if(filter.isAllowed(addresses[i % addresses.size()], cache)) ++num_allowed;
+            }
+        });
+
+        ofLogNotice("address filter") << addresses.size() << " addresses, " << num_messages << " messages";
+        ofLogNotice("address filter") << "  std::set exact lookup : " << exact << " ns/message";
+        ofLogNotice("address filter") << "  pattern, no cache     : " << uncached << " ns/message";
+        ofLogNotice("address filter") << "  pattern, cached       : " << cached << " ns/message";
+        ofLogVerbose("address filter") << num_allowed;
+    }
+
+#pragma mark compression
+
+    void benchmark_compression() {
+        // 8 sensors at 200Hz, smooth values
+        const std::size_t num_records = 100 * 1000;
+        std::vector<ofx::RecordOsc::SequenceData> records(num_records);
+        for(std::size_t i = 0; i < num_records; ++i) {
+            auto &data = records[i];
+            auto channel = static_cast<int>(i % 8);
+            float t = i / 200.0f;
+            data.setOffsetNanos(static_cast<std::int64_t>(i) * 5000000);
+            data.mess.setAddress(ofVAArgsToString("/sensor/%d/accel", channel));
+            data.mess.setWaitingPort(9000);
+            data.mess.addFloatArg(std::sin(t + channel));
+            data.mess.addFloatArg(std::cos(t * 0.5f));
+            data.mess.addFloatArg(0.5f);
+            data.mess.addInt32Arg(static_cast<std::int32_t>(i / 8));
+        }
+
+        auto &&path = ofToDataPath("benchmark_compression.oscrec", true);
+        ofLogNotice("compression") << num_records << " records";
+        for(auto compression : {ofxRecordOscCompression::None,
+                                ofxRecordOscCompression::Delta,
+                                ofxRecordOscCompression::LZ4,
+                                ofxRecordOscCompression::Zstd})
+        {
+            ofx::RecordOsc::Metadata metadata;
+            metadata.start();
+            ofxRecordOscNativeWriter writer;
+            writer.setCompression(compression);
+            if(!writer.open(path, metadata)) return;
+            auto write = measure_ns_per_op(num_records, [&] {
+                for(const auto &data : records) writer.append(data);
+                metadata.finishNanos(records.back().offset_ns);
+                writer.close(metadata);
+            });
+            auto size = ofFile(path).getSize();
+
+            std::vector<ofx::RecordOsc::SequenceData> loaded;
+            ofxRecordOscNativeReader reader;
+            auto read = measure_ns_per_op(num_records, [&] {
+                reader.read(path, loaded);
+            });
+
+            // lazy playback (Player::setupLazy) reads a short window per tick
+            const std::int64_t tick_ns = 1000000000 / 60;
+            std::size_t num_played = 0;
+            ofxRecordOscNativeMappedReader mapped;
+            auto lazy = measure_ns_per_op(num_records, [&] {
+                if(!mapped.open(path)) return;
+                for(std::int64_t from = 0; from <= records.back().offset_ns; from += tick_ns) {
+                    mapped.forEachRecordInRange(from, from + tick_ns - 1, [&](const ofx::RecordOsc::SequenceData &) {
+                        ++num_played;
+                    });
+                }
+            });
+            ofLogNotice("compression") << "  " << static_cast<int>(writer.getCompression())
+                                       << " : " << size << " bytes, write " << write
+                                       << " ns/record, load " << read << " ns/record"
+                                       << ", lazy playback per tick " << lazy << " ns/record";
+            ofLogVerbose("compression") << num_played;
+        }
+        ofFile::removeFile(path, false);
+    }
+
+#pragma mark columnar tracks
+
+    void benchmark_tracks() {
+        const std::size_t num_rows = 10 * 1000 * 1000;
+        ofxRecordOscTrack track;
+        track.address = "/sensor/0/accel";
+        track.offsets.resize(num_rows);
+        track.columns.assign(1, std::vector<double>(num_rows));
+        for(std::size_t i = 0; i < num_rows; ++i) {
+            track.offsets[i] = i * 0.005;
+            track.columns[0][i] = std::sin(i * 0.001);
+        }
+
+        ofxRecordOscColumnStats stats;
+        auto stats_ns = measure_ns_per_op(num_rows, [&] {
+            stats = track.stats(0);
+        });
+        std::vector<double> samples;
+        auto resample_ns = measure_ns_per_op(num_rows, [&] {
+            samples = track.resample(0, 0.01);
+        });
+
+        ofLogNotice("tracks") << num_rows << " rows";
+        ofLogNotice("tracks") << "  min / max / mean : " << stats_ns * num_rows / 1000000.0 << " ms";
+        ofLogNotice("tracks") << "  resample 100Hz   : " << resample_ns * num_rows / 1000000.0 << " ms";
+        ofLogVerbose("tracks") << stats.mean << " " << samples.size();
+    }
+
+#pragma mark parallel loading
+
+    void benchmark_parallel_loading() {
+        const std::size_t num_records = 2 * 1000 * 1000;
+        auto &&path = ofToDataPath("benchmark_parallel.oscrec", true);
+        {
+            ofx::RecordOsc::Metadata metadata;
+            metadata.start();
+            ofxRecordOscNativeWriter writer;
+            writer.setCompression(ofxRecordOscCompression::Delta);
+            if(!writer.open(path, metadata)) return;
+            ofx::RecordOsc::SequenceData data;
+            for(std::size_t i = 0; i < num_records; ++i) {
+                data.mess.clear();
+                data.setOffsetNanos(static_cast<std::int64_t>(i) * 500000);
+                data.timetag = 0;
+                data.mess.setAddress(ofVAArgsToString("/sensor/%d/accel", static_cast<int>(i % 64)));
+                data.mess.setWaitingPort(9000);
+                data.mess.addFloatArg(std::sin(i * 0.01f));
+                data.mess.addFloatArg(std::cos(i * 0.01f));
+                data.mess.addInt32Arg(static_cast<std::int32_t>(i));
+                writer.append(data);
+            }
+            metadata.finishNanos(data.offset_ns);
+            writer.close(metadata);
+        }
+
+        ofLogNotice("parallel loading") << num_records << " records, Delta";
+        auto max_threads = ofx::RecordOsc::detail::hardware_threads();
+        for(std::size_t num_threads = 1; ; num_threads = std::min(num_threads * 2, max_threads)) {
+            ofxRecordedOscPlayer player;
+            player.setLoadThreads(num_threads);
+            auto load_ms = measure_ms([&] {
+                player.setup(path, ofxRecordOscFileFormat::Native);
+            });
+            ofLogNotice("parallel loading") << "  " << num_threads << " threads : " << load_ms << " ms (" << player.numMessages() << " messages)";
+            if(num_threads == max_threads) break;
+        }
+        ofFile::removeFile(path, false);
+    }
+
+#pragma mark network playback
+
+    // Player::playNanos(host, ...) (ofxSendOsc per message) vs Player::playBundledNanos per tick,
+    // without and with pre-encoded messages (Player::setPreEncode)
+    void benchmark_network_playback() {
+        const std::size_t num_records = 2000 * 60; // 2 kHz capture of 60 sec
+        const std::int64_t interval_ns = 500000;
+        const std::int64_t tick_ns = 1000000000 / 60;
+        auto &&path = ofToDataPath("benchmark_network.oscrec", true);
+        {
+            ofx::RecordOsc::Metadata metadata;
+            metadata.start();
+            ofxRecordOscNativeWriter writer;
+            if(!writer.open(path, metadata)) return;
+            ofx::RecordOsc::SequenceData data;
+            for(std::size_t i = 0; i < num_records; ++i) {
+                data.mess.clear();
+                data.setOffsetNanos(static_cast<std::int64_t>(i) * interval_ns);
+                data.timetag = 0;
+                data.mess.setAddress(ofVAArgsToString("/sensor/%d/accel", static_cast<int>(i % 16)));
+                data.mess.setWaitingPort(static_cast<std::uint16_t>(19000 + i % 2));
+                data.mess.addFloatArg(std::sin(i * 0.01f));
+                data.mess.addFloatArg(std::cos(i * 0.01f));
+                data.mess.addFloatArg(std::sin(i * 0.02f));
+                writer.append(data);
+            }
+            metadata.finishNanos(data.offset_ns);
+            writer.close(metadata);
+        }
+
+        ofxRecordedOscPlayer player;
+        player.setup(path, ofxRecordOscFileFormat::Native);
+        auto duration_ns = player.durationNanos();
+        ofLogNotice("network playback") << num_records << " records (2 kHz, 60 sec) to loopback, 60 ticks / sec";
+        for(auto pre_encode : {false, true}) {
+            auto encode_ms = measure_ms([&] {
+                player.setPreEncode(pre_encode);
+            });
+            if(pre_encode) {
+                ofLogNotice("network playback") << "pre-encoded: " << encode_ms << " ms, " << player.getPreEncodedSize() / 1024 << " KiB";
+            }
+            // nobody listens the ports, datagrams are dropped by kernel
+            auto per_message_ms = measure_ms([&] {
+                for(std::int64_t from = 0; from <= duration_ns; from += tick_ns) {
+                    player.playNanos("127.0.0.1", from, from + tick_ns - 1);
+                }
+            });
+            auto datagrams_before = player.getBundledSenderStats().num_datagrams;
+            auto syscalls_before = player.getBundledSenderStats().num_syscalls;
+            auto bundled_ms = measure_ms([&] {
+                for(std::int64_t from = 0; from <= duration_ns; from += tick_ns) {
+                    player.playBundledNanos("127.0.0.1", from, from + tick_ns - 1);
+                }
+            });
+            const auto &stats = player.getBundledSenderStats();
+
+            std::string suffix = pre_encode ? ", pre-encoded" : "";
+            ofLogNotice("network playback") << "  per message" << suffix << " : " << per_message_ms << " ms, " << num_records / per_message_ms * 1000.0 << " messages / sec";
+            ofLogNotice("network playback") << "  bundled" << suffix << "     : " << bundled_ms << " ms, " << num_records / bundled_ms * 1000.0 << " messages / sec"
+                                            << " (" << stats.num_datagrams - datagrams_before << " datagrams, " << stats.num_syscalls - syscalls_before << " syscalls)";
+        }
+        ofFile::removeFile(path, false);
+    }
+
+#pragma mark loading of document formats
+
+    // DOM of whole file (previous Player::setup) vs SAX decoding of SequenceReader
+    void benchmark_sequence_loading() {
+        using ofx::RecordOsc::FileFormat;
+        const std::size_t num_records = 500 * 1000;
+        ofJson json;
+        {
+            std::vector<ofx::RecordOsc::SequenceData> records(num_records);
+            for(std::size_t i = 0; i < num_records; ++i) {
+                auto &data = records[i];
+                auto channel = static_cast<int>(i % 32);
+                data.setOffsetNanos(static_cast<std::int64_t>(i) * 1000000);
+                data.timetag = 0;
+                data.mess.setAddress(ofVAArgsToString("/sensor/%d/accel", channel));
+                data.mess.setRemoteEndpoint("127.0.0.1", 50000);
+                data.mess.setWaitingPort(9000);
+                data.mess.addFloatArg(std::sin(i * 0.01f));
+                data.mess.addFloatArg(std::cos(i * 0.01f));
+                data.mess.addInt32Arg(static_cast<std::int32_t>(i));
+                data.mess.addStringArg("label");
+            }
+            ofx::RecordOsc::Metadata metadata;
+            metadata.start();
+            metadata.finishNanos(records.back().offset_ns);
+            json["metadata"] = metadata;
+            json["sequence"] = records;
+        }
+
+        ofLogNotice("sequence loading") << num_records << " records, peak heap is measured from baseline";
+        for(auto format : {FileFormat::Json,
+                           FileFormat::Bson,
+                           FileFormat::CBOR,
+                           FileFormat::MessagePack,
+                           FileFormat::UBJson})
+        {
+            auto &&ext = ofx::RecordOsc::detail::to_ext(format);
+            auto &&path = ofToDataPath("benchmark_loading." + ext, true);
+            if(!ofx::RecordOsc::detail::save(path, json, format)) continue;
+
+            std::size_t dom_peak = 0, dom_size = 0;
+            auto dom_ms = measure_ms([&] {
+                auto baseline = heap_usage::resetPeak();
+                std::vector<ofx::RecordOsc::SequenceData> sequence;
+                ofx::RecordOsc::Metadata metadata;
+                {
+                    auto &&loaded = ofx::RecordOsc::detail::load(path, format);
+                    sequence = loaded["sequence"].get<decltype(sequence)>();
+                    metadata = loaded["metadata"];
+                }
+                dom_peak = heap_usage::peak().load() - baseline;
+                dom_size = sequence.size();
+            });
+
+            std::size_t sax_peak = 0, sax_size = 0;
+            auto sax_ms = measure_ms([&] {
+                auto baseline = heap_usage::resetPeak();
+                std::vector<ofx::RecordOsc::SequenceData> sequence;
+                ofxRecordOscSequenceReader reader;
+                reader.read(path, format, sequence);
+                sax_peak = heap_usage::peak().load() - baseline;
+                sax_size = sequence.size();
+            });
+
+            ofLogNotice("sequence loading") << "  " << ext << " : " << ofFile(path).getSize() << " bytes";
+            ofLogNotice("sequence loading") << "    DOM : " << dom_ms << " ms, peak heap " << dom_peak / (1024.0 * 1024.0) << " MiB (" << dom_size << " records)";
+            ofLogNotice("sequence loading") << "    SAX : " << sax_ms << " ms, peak heap " << sax_peak / (1024.0 * 1024.0) << " MiB (" << sax_size << " records)";
+            ofFile::removeFile(path, false);
+        }
+    }
+
+#pragma mark arguments without payload
+
+    // arguments of every type. Nil and Trigger have no payload but a typetag
+    void add_all_arguments(ofxOscMessage &m) {
+        m.addInt32Arg(1);
+        m.addNoneArg();
+        m.addTriggerArg();
+        m.addBoolArg(true);
+        m.addBoolArg(false);
+        m.addInt64Arg(2);
+        m.addFloatArg(0.5f);
+        m.addDoubleArg(0.25);
+        m.addStringArg("string");
+        m.addSymbolArg("symbol");
+        m.addCharArg('c');
+        m.addMidiMessageArg(0x00904060);
+        m.addRgbaColorArg(0x00FF8040);
+        m.addTimetagArg(1);
+        ofBuffer blob("blob", 4);
+        m.addBlobArg(blob);
+        m.addNoneArg();
+    }
+
+    // arguments received by Recorder::listen are recorded as they are sent
+    void check_recorder_arguments() {
+        const std::uint16_t port = 23457;
+        ofxOscRecorder recorder;
+        recorder.setup("/check/start", "/check/stop");
+        recorder.setFileFormat(ofxRecordOscFileFormat::Native);
+        recorder.listen(port);
+        recorder.startRecording(ofxOscRecorder::clock::now());
+
+        ofxOscMessage sent;
+        sent.setAddress("/check/arguments");
+        add_all_arguments(sent);
+        ofxOscSender sender;
+        sender.setup("127.0.0.1", port);
+        sender.sendMessage(sent, false);
+        auto begin = bench_clock::now();
+        while(recorder.numWrittenMessages() == 0 && bench_clock::now() - begin < std::chrono::seconds(1)) {
+            ofEvents().notifyUpdate();
+        }
+        recorder.stopRecording("check_arguments");
+        auto &&path = recorder.lastSavedPath();
+        ofEventArgs args;
+        recorder.exit(args);
+
+        std::vector<ofx::RecordOsc::SequenceData> sequence;
+        ofxRecordOscNativeReader reader;
+        if(path.empty() || !reader.read(path, sequence) || sequence.empty()) {
+            ofLogError("arguments") << "Recorder::listen recorded nothing";
+        } else if(sequence.front().mess.getTypeString() != sent.getTypeString()) {
+            ofLogError("arguments") << "Recorder::listen recorded typetags " << sequence.front().mess.getTypeString()
+                                    << ", sent " << sent.getTypeString();
+        } else {
+            ofLogNotice("arguments") << "Recorder::listen keeps typetags " << sent.getTypeString();
+        }
+        if(!path.empty()) ofFile::removeFile(path, false);
+    }
+
+    // per message playback (ofxOscSender) and bundled playback send same bytes of message.
+    // both are recorded by Recorder::listenRaw, message of bundle is compared with datagram of per message
+    void check_playback_arguments() {
+        const std::uint16_t port = 23458;
+        auto &&path = ofToDataPath("check_playback.oscrec", true);
+        {
+            ofx::RecordOsc::Metadata metadata;
+            metadata.start();
+            ofxRecordOscNativeWriter writer;
+            if(!writer.open(path, metadata)) return;
+            ofx::RecordOsc::SequenceData data;
+            data.setOffsetNanos(0);
+            data.timetag = 0;
+            data.mess.setAddress("/check/playback");
+            data.mess.setWaitingPort(port);
+            add_all_arguments(data.mess);
+            writer.append(data);
+            metadata.finishNanos(data.offset_ns);
+            writer.close(metadata);
+        }
+
+        ofxOscRecorder recorder;
+        recorder.setup("/check/start", "/check/stop");
+        recorder.setFileFormat(ofxRecordOscFileFormat::Native);
+        if(!recorder.listenRaw(port)) return;
+        recorder.startRecording(ofxOscRecorder::clock::now());
+        auto wait_written = [&](std::uint64_t num) {
+            auto begin = bench_clock::now();
+            while(recorder.numWrittenMessages() < num && bench_clock::now() - begin < std::chrono::seconds(1)) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        };
+        ofxRecordedOscPlayer player;
+        player.setup(path, ofxRecordOscFileFormat::Native);
+        player.playNanos("127.0.0.1", 0, 0);
+        wait_written(1);
+        player.playBundledNanos("127.0.0.1", 0, 0);
+        wait_written(2);
+        player.setPreEncode(true);
+        player.playBundledNanos("127.0.0.1", 0, 0);
+        wait_written(3);
+        recorder.stopRecording("check_playback");
+        auto &&recorded_path = recorder.lastSavedPath();
+        ofEventArgs args;
+        recorder.exit(args);
+        ofFile::removeFile(path, false);
+
+        ofxRecordedOscPlayer recorded;
+        if(!recorded_path.empty()) recorded.setup(recorded_path, ofxRecordOscFileFormat::Native);
+        if(recorded.getPackets().size() != 3) {
+            ofLogError("arguments") << "playback of message is not recorded";
+            if(!recorded_path.empty()) ofFile::removeFile(recorded_path, false);
+            return;
+        }
+        const auto &packets = recorded.getPackets();
+        const auto &message = packets[0].bytes;
+        // "#bundle", timetag, size of the first element
+        const std::size_t element_position = 20;
+        for(std::size_t i = 1; i < packets.size(); ++i) {
+            const auto &bundle = packets[i].bytes;
+            std::string name = i == 1 ? "bundled" : "bundled, pre-encoded";
+            if(bundle.size() != element_position + message.size()
+               || !std::equal(message.begin(), message.end(), bundle.begin() + element_position))
+            {
+                ofLogError("arguments") << name << " playback sends other bytes than per message playback";
+            } else {
+                ofLogNotice("arguments") << name << " playback sends same " << message.size() << " bytes as per message playback";
+            }
+        }
+        ofFile::removeFile(recorded_path, false);
+    }
+
+#pragma mark recorder load
+
+    // traffic sent to Recorder::listen over loopback UDP
+    struct traffic_config {
+        std::string name;
+        std::size_t num_addresses;
+        std::size_t num_float_args;
+        bool with_string;
+        double rate;         // messages per sec
+        std::size_t burst;   // messages sent back-to-back per tick
+        double duration_sec;
+    };
+
+    double percentile(std::vector<double> &values, double p) {
+        if(values.empty()) return 0.0;
+        auto index = static_cast<std::size_t>(p * (values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+
+    // returns path of recorded file
+    std::string benchmark_recorder_load(ofxOscRecorder &recorder,
+                                        std::uint16_t port,
+                                        const traffic_config &config)
+    {
+        auto num_messages = static_cast<std::size_t>(config.rate * config.duration_sec);
+        auto num_ticks = (num_messages + config.burst - 1) / config.burst;
+        auto tick_interval = std::chrono::duration_cast<bench_clock::duration>(std::chrono::duration<double>(config.burst / config.rate));
+
+        std::vector<ofxOscMessage> templates(config.num_addresses);
+        for(std::size_t i = 0; i < templates.size(); ++i) {
+            templates[i].setAddress(ofVAArgsToString("/bench/%d/value", static_cast<int>(i)));
+        }
+        std::vector<bench_clock::time_point> sent_at(num_messages);
+        std::atomic<std::size_t> num_sent{0};
+        auto dropped_before = recorder.numDroppedMessages();
+
+        recorder.startRecording(ofxOscRecorder::clock::now());
+        auto begin = bench_clock::now();
+
+        std::thread sender_thread([&] {
+            ofxOscSender sender;
+            sender.setup("127.0.0.1", port);
+            for(std::size_t tick = 0; tick < num_ticks; ++tick) {
+                std::this_thread::sleep_until(begin + tick_interval * tick);
+                for(std::size_t k = 0; k < config.burst; ++k) {
+                    auto index = num_sent.load();
+                    if(num_messages <= index) break;
+                    ofxOscMessage m = templates[index % templates.size()];
+                    m.addInt32Arg(static_cast<std::int32_t>(index));
+                    for(std::size_t a = 0; a < config.num_float_args; ++a) m.addFloatArg(std::sin(index * 0.01f + a));
+                    if(config.with_string) m.addStringArg("payload");
+                    sent_at[index] = bench_clock::now();
+                    sender.sendMessage(m, false);
+                    num_sent = index + 1;
+                }
+            }
+        });
+
+        // ofxPubSubOsc dispatches received messages on update event, so main thread pumps it
+        // while sampling queue depth and progress of writer.
+        std::vector<std::pair<bench_clock::time_point, std::uint64_t>> progress;
+        std::size_t max_depth = 0;
+        double sum_depth = 0.0;
+        std::size_t num_depth_samples = 0;
+        auto last_progress = bench_clock::now();
+        bool sending = true;
+        while(true) {
+            ofEvents().notifyUpdate();
+            auto depth = recorder.numPendingMessages();
+            max_depth = std::max(max_depth, depth);
+            sum_depth += depth;
+            ++num_depth_samples;
+            // time after reading progress, so latency is never underestimated
+            auto written = recorder.numWrittenMessages();
+            auto now = bench_clock::now();
+            if(progress.empty() || progress.back().second != written) {
+                progress.emplace_back(now, written);
+                last_progress = now;
+            }
+            if(sending && num_sent == num_messages) {
+                sending = false;
+                last_progress = now;
+            }
+            auto received = written + recorder.numDroppedMessages() - dropped_before;
+            // rest are lost if nothing arrives for a while
+            if(!sending && (num_messages <= received || std::chrono::milliseconds(500) < now - last_progress)) break;
+        }
+        sender_thread.join();
+        auto written = recorder.numWrittenMessages();
+        auto dropped = recorder.numDroppedMessages() - dropped_before;
+        recorder.stopRecording("benchmark_recorder-" + config.name);
+
+        // n-th written message is regarded as n-th sent one. approximate if messages are lost
+        std::vector<double> latencies;
+        latencies.reserve(written);
+        std::uint64_t done = 0;
+        for(const auto &p : progress) {
+            for(; done < p.second && done < num_messages; ++done) {
+                latencies.push_back(std::chrono::duration<double, std::micro>(p.first - sent_at[done]).count());
+            }
+        }
+        auto elapsed = std::chrono::duration<double>(progress.back().first - begin).count();
+
+        ofLogNotice("recorder load") << config.name << ": " << config.num_addresses << " addresses, "
+                                     << config.num_float_args << " floats" << (config.with_string ? " + string" : "")
+                                     << ", " << config.rate << " msg/s, burst " << config.burst;
+        ofLogNotice("recorder load") << "  sent " << num_messages << ", written " << written
+                                     << ", dropped (queue full) " << dropped
+                                     << ", lost " << (num_messages - std::min<std::uint64_t>(num_messages, written + dropped));
+        ofLogNotice("recorder load") << "  throughput " << written / elapsed << " msg/s";
+        ofLogNotice("recorder load") << "  queue depth max " << max_depth << ", mean " << sum_depth / std::max<std::size_t>(1, num_depth_samples);
+        ofLogNotice("recorder load") << "  send -> written latency [us] p50 " << percentile(latencies, 0.5)
+                                     << ", p99 " << percentile(latencies, 0.99)
+                                     << ", p99.9 " << percentile(latencies, 0.999)
+                                     << ", max " << percentile(latencies, 1.0);
+        return recorder.lastSavedPath();
+    }
+
+    // same conversion as Recorder::saveData, and loading by Player
+    void benchmark_file_formats(const std::string &native_path) {
+        using ofx::RecordOsc::FileFormat;
+        auto &&json = ofx::RecordOsc::detail::load(native_path, FileFormat::Native);
+        for(auto format : {FileFormat::Native,
+                           FileFormat::Json,
+                           FileFormat::Bson,
+                           FileFormat::CBOR,
+                           FileFormat::MessagePack,
+                           FileFormat::UBJson})
+        {
+            auto &&ext = ofx::RecordOsc::detail::to_ext(format);
+            auto &&path = ofToDataPath("benchmark_format." + ext, true);
+            auto save_ms = measure_ms([&] {
+                ofx::RecordOsc::detail::save(path, json, format);
+            });
+            ofxRecordedOscPlayer player;
+            auto load_ms = measure_ms([&] {
+                player.setup(path, format);
+            });
+            ofLogNotice("file format") << "  " << ext << " : " << ofFile(path).getSize() << " bytes, save "
+                                       << save_ms << " ms, load " << load_ms << " ms (" << player.numMessages() << " messages)";
+            ofFile::removeFile(path, false);
+        }
+    }
+
+    void benchmark_recorder() {
+        const std::uint16_t port = 23456;
+        ofxOscRecorder recorder;
+        recorder.setup("/bench/start", "/bench/stop");
+        recorder.setFileFormat(ofxRecordOscFileFormat::Native);
+        recorder.listen(port);
+
+        std::vector<traffic_config> configs = {
+            {"steady",   64,  4, false,  10000,   1, 3.0},
+            {"fast",     64,  4, false, 100000,  10, 3.0},
+            {"bursty",  256,  8, true,   50000, 500, 3.0},
+            {"flood",     8,  1, false, 500000, 100, 2.0},
+        };
+        // save / load of formats are measured with recording of mixed arguments
+        const std::string format_source = "bursty";
+        std::string recorded_path;
+        for(const auto &config : configs) {
+            auto &&path = benchmark_recorder_load(recorder, port, config);
+            if(path.empty()) continue;
+            if(config.name == format_source) recorded_path = path;
+            else ofFile::removeFile(path, false);
+        }
+
+        ofEventArgs args;
+        recorder.exit(args);
+        if(recorded_path.empty()) return;
+        ofLogNotice("file format") << "save / load of recording \"" << format_source << "\"";
+        benchmark_file_formats(recorded_path);
+        ofFile::removeFile(recorded_path, false);
+    }
+};
+
+int main() {
+    ofSetLogLevel(OF_LOG_NOTICE);
+    benchmark_address_filter();
+    benchmark_compression();
+    benchmark_tracks();
+    benchmark_parallel_loading();
+    benchmark_network_playback();
+    benchmark_sequence_loading();
+    check_recorder_arguments();
+    check_playback_arguments();
+    benchmark_recorder();
+}
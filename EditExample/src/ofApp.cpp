@@ -0,0 +1,132 @@
+#include "ofMain.h"
+#include "ofxRecordOscEditor.h"
+
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <set>
+
+// headless editor of recordings.
+//
+//   merge recordings of 2 machines, second one is 0.25 sec late:
+//     EditExample merge -o merged.oscrec a.oscrec b.oscrec@-0.25
+//   cut 2 minutes from 1 hour with only /sensor/*:
+//     EditExample merge --from 3600 --to 3720 -w "/sensor/*" -o excerpt.oscrec take.oscrec
+//   join segments of session with 1 sec gap:
+//     EditExample concat --gap 1 -o joined.json seg-0.oscrec seg-1.oscrec
+//
+// input is path[@shift sec]. format of input and output is given by its extension (json, bson, cbor, msgpack, ubjson, oscrec).
+
+namespace {
+    void print_usage() {
+        ofLogNotice("EditExample") << "usage: EditExample merge|concat [--from sec] [--to sec] [-w pattern]... [-b pattern]... [--gap sec] [-c none|delta|lz4|zstd] -o output input[@shift] ...";
+    }
+
+    bool to_format(const std::string &path, ofxRecordOscFileFormat &format) {
+        auto ext = ofToLower(ofFilePath::getFileExt(path));
+        for(auto f : { ofxRecordOscFileFormat::Json,
+                       ofxRecordOscFileFormat::Bson,
+                       ofxRecordOscFileFormat::CBOR,
+                       ofxRecordOscFileFormat::MessagePack,
+                       ofxRecordOscFileFormat::UBJson,
+                       ofxRecordOscFileFormat::Native })
+        {
+            if(ext == ofx::RecordOsc::detail::to_ext(f)) {
+                format = f;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool to_compression(const std::string &name, ofxRecordOscCompression &compression) {
+        if(name == "none") compression = ofxRecordOscCompression::None;
+        else if(name == "delta") compression = ofxRecordOscCompression::Delta;
+        else if(name == "lz4") compression = ofxRecordOscCompression::LZ4;
+        else if(name == "zstd") compression = ofxRecordOscCompression::Zstd;
+        else return false;
+        return true;
+    }
+
+    std::int64_t to_nanos(const std::string &sec)
+    { return std::llround(std::atof(sec.c_str()) * 1000000000.0); };
+};
+
+int main(int argc, char *argv[]) {
+    ofSetLogLevel(OF_LOG_NOTICE);
+    if(argc < 2) {
+        print_usage();
+        return 1;
+    }
+    std::string command = argv[1];
+    if(command != "merge" && command != "concat") {
+        print_usage();
+        return 1;
+    }
+
+    ofxRecordOscEditor editor;
+    std::string output;
+    std::set<std::string> whitelists, blacklists;
+    bool has_from = false, has_to = false;
+    std::int64_t from_ns = 0, to_ns = 0, gap_ns = 0;
+    for(int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "-o" && has_value) {
+            output = argv[++i];
+        } else if(arg == "--from" && has_value) {
+            from_ns = to_nanos(argv[++i]);
+            has_from = true;
+        } else if(arg == "--to" && has_value) {
+            to_ns = to_nanos(argv[++i]);
+            has_to = true;
+        } else if(arg == "--gap" && has_value) {
+            gap_ns = to_nanos(argv[++i]);
+        } else if(arg == "-w" && has_value) {
+            whitelists.insert(argv[++i]);
+        } else if(arg == "-b" && has_value) {
+            blacklists.insert(argv[++i]);
+        } else if(arg == "-c" && has_value) {
+            ofxRecordOscCompression compression;
+            if(!to_compression(argv[++i], compression)) {
+                print_usage();
+                return 1;
+            }
+            editor.setCompression(compression);
+        } else if(!arg.empty() && arg[0] == '-') {
+            print_usage();
+            return 1;
+        } else {
+            auto at = arg.rfind('@');
+            auto path = arg.substr(0, at);
+            std::int64_t shift_ns = at == std::string::npos ? 0 : to_nanos(arg.substr(at + 1));
+            ofxRecordOscFileFormat format;
+            if(!to_format(path, format)) {
+                ofLogError("EditExample") << "unknown format of " << path;
+                return 1;
+            }
+            editor.addInput(path, format, shift_ns);
+        }
+    }
+
+    ofxRecordOscFileFormat format;
+    if(editor.numInputs() == 0 || output.empty() || !to_format(output, format)) {
+        print_usage();
+        return 1;
+    }
+    if(has_from || has_to) {
+        editor.setRangeNanos(has_from ? from_ns : 0,
+                             has_to ? to_ns : std::numeric_limits<std::int64_t>::max());
+    }
+    if(!whitelists.empty() || !blacklists.empty()) editor.setAddressFilter(whitelists, blacklists);
+
+    auto result = command == "merge"
+                ? editor.merge(output, format)
+                : editor.concatenate(output, format, gap_ns);
+    ofLogNotice("EditExample") << (result.succeeded ? "wrote " : "failed to write ") << result.path;
+    ofLogNotice("EditExample") << "  records:  " << result.num_records;
+    ofLogNotice("EditExample") << "  filtered: " << result.num_filtered;
+    ofLogNotice("EditExample") << "  duration: " << result.duration_sec << " sec";
+    ofLogNotice("EditExample") << "  edited in " << result.edit_duration_ms << " ms";
+    return result.succeeded ? 0 : 1;
+}
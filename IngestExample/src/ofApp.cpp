@@ -0,0 +1,95 @@
+#include "ofMain.h"
+#include "ofxRecordOscPcapIngest.h"
+
+#include <cstdlib>
+#include <cstring>
+
+// headless converter of packet captures into recordings.
+//
+//   tcpdump -i any -w capture.pcap udp port 9000
+//   IngestExample -p 9000 -o recording.oscrec capture.pcap
+//
+// format of output is given by its extension (json, bson, cbor, msgpack, ubjson, oscrec).
+
+namespace {
+    void print_usage() {
+        ofLogNotice("IngestExample") << "usage: IngestExample [-p port]... [-j threads] [-c none|delta|lz4|zstd] [--raw] -o output capture.pcap [capture.pcapng ...]";
+    }
+
+    bool to_format(const std::string &path, ofxRecordOscFileFormat &format) {
+        auto ext = ofToLower(ofFilePath::getFileExt(path));
+        for(auto f : { ofxRecordOscFileFormat::Json,
+                       ofxRecordOscFileFormat::Bson,
+                       ofxRecordOscFileFormat::CBOR,
+                       ofxRecordOscFileFormat::MessagePack,
+                       ofxRecordOscFileFormat::UBJson,
+                       ofxRecordOscFileFormat::Native })
+        {
+            if(ext == ofx::RecordOsc::detail::to_ext(f)) {
+                format = f;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool to_compression(const std::string &name, ofxRecordOscCompression &compression) {
+        if(name == "none") compression = ofxRecordOscCompression::None;
+        else if(name == "delta") compression = ofxRecordOscCompression::Delta;
+        else if(name == "lz4") compression = ofxRecordOscCompression::LZ4;
+        else if(name == "zstd") compression = ofxRecordOscCompression::Zstd;
+        else return false;
+        return true;
+    }
+};
+
+int main(int argc, char *argv[]) {
+    ofSetLogLevel(OF_LOG_NOTICE);
+    ofxRecordOscPcapIngest ingest;
+    std::vector<std::string> captures;
+    std::string output;
+    for(int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if(arg == "-o" && has_value) {
+            output = argv[++i];
+        } else if(arg == "-p" && has_value) {
+            ingest.addPort(static_cast<std::uint16_t>(std::atoi(argv[++i])));
+        } else if(arg == "-j" && has_value) {
+            ingest.setThreads(static_cast<std::size_t>(std::atoi(argv[++i])));
+        } else if(arg == "-c" && has_value) {
+            ofxRecordOscCompression compression;
+            if(!to_compression(argv[++i], compression)) {
+                print_usage();
+                return 1;
+            }
+            ingest.setCompression(compression);
+        } else if(arg == "--raw") {
+            ingest.setRawPackets(true);
+        } else if(!arg.empty() && arg[0] == '-') {
+            print_usage();
+            return 1;
+        } else {
+            captures.push_back(arg);
+        }
+    }
+
+    ofxRecordOscFileFormat format;
+    if(captures.empty() || output.empty() || !to_format(output, format)) {
+        print_usage();
+        return 1;
+    }
+
+    auto result = ingest.ingest(captures, output, format);
+    ofLogNotice("IngestExample") << (result.succeeded ? "ingested " : "failed to ingest ") << result.path;
+    ofLogNotice("IngestExample") << "  frames:     " << result.num_frames;
+    ofLogNotice("IngestExample") << "  datagrams:  " << result.num_datagrams;
+    ofLogNotice("IngestExample") << "  records:    " << result.num_records;
+    ofLogNotice("IngestExample") << "  skipped:    " << result.num_skipped;
+    ofLogNotice("IngestExample") << "  fragmented: " << result.num_fragmented;
+    ofLogNotice("IngestExample") << "  truncated:  " << result.num_truncated;
+    ofLogNotice("IngestExample") << "  broken:     " << result.num_broken;
+    ofLogNotice("IngestExample") << "  duration:   " << result.duration_sec << " sec";
+    ofLogNotice("IngestExample") << "  ingested in " << result.ingest_duration_ms << " ms on " << ingest.getThreads() << " threads";
+    return result.succeeded ? 0 : 1;
+}
@@ -3,6 +3,7 @@
 
 class ofApp : public ofBaseApp {
     ofxOscRecorder recorder;
+    std::vector<ofxRecordOscAddressStats> address_stats;
 public:
     void setup() {
         // start recording: send "/start" to 22222 or 26666
@@ -13,6 +14,12 @@ public:
         // save as json-like format
 //        recorder.setFileFormat(ofxRecordOscFileFormat::MessagePack);
         
+        // split long recording into segments per 10 min or 256MB
+//        recorder.setSegmentRotation(10 * 60, 256 * 1024 * 1024);
+        
+        // compress native chunks (LZ4 / Zstd need OFX_RECORD_OSC_USE_LZ4 / OFX_RECORD_OSC_USE_ZSTD)
+//        recorder.setCompression(ofxRecordOscCompression::Delta);
+        
         // for non-realtime or custom time measure recording
 //        recorder.setCustomTimeCalculator([](const ofxOscMessageEx &mess, double) {
 //            return mess[0].as<float>();
@@ -22,6 +29,8 @@ public:
 //        recorder.addBlacklist("/ping");
 //        std::vector<std::string> blacklists = {{"/ping", "/hb"}};
 //        recorder.addBlacklists(blacklists);
+        // OSC address pattern is also available
+//        recorder.addBlacklist("/sensor/*/debug");
 
         // allow only specific messages
         // if not set whitelist, then allow all
@@ -29,12 +38,18 @@ public:
 //        std::vector<std::string> whitelists = {{"/needed/message", "/needed/value"}};
 //        recorder.addWhitelists(whitelists);
 
+        // send metrics of recorder to monitoring app every sec
+//        recorder.publishMetrics("localhost", 9999, 1.0);
+
         // setup listen ports
         recorder.listen(22222);
         recorder.listen(26666);
+        // record datagrams of port as is (bundles and timetags are kept, see Player::playPackets)
+//        recorder.listenRaw(27777);
     }
     void update() {
-        
+        // rate is measured between calls
+        if(ofGetFrameNum() % 30 == 0) address_stats = recorder.getAddressStats();
     }
     void draw() {
         ofSetColor(255);
@@ -42,6 +57,11 @@ public:
                                     20, 20,
                                     recorder.isRecordingNow() ? ofColor::red : ofColor(0, 0));
         ofDrawBitmapString(recorder.digestString(), 20, 40);
+        float y = 40;
+        for(const auto &stats : address_stats) {
+            ofDrawBitmapString(ofVAArgsToString("%s %.1f/s %g", stats.address.c_str(), stats.rate, stats.last_value), 420, y);
+            y += 14;
+        }
     }
     void exit() {
         
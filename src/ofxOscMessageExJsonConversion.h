@@ -11,6 +11,21 @@
 #include "ofxOscMessageEx.h"
 #include "ofJson.h"
 
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// binary type of nlohmann::json is available since 3.8.0
+#if defined(NLOHMANN_JSON_VERSION_MAJOR) && (3 < NLOHMANN_JSON_VERSION_MAJOR || (NLOHMANN_JSON_VERSION_MAJOR == 3 && 8 <= NLOHMANN_JSON_VERSION_MINOR))
+#   define OFX_RECORD_OSC_HAS_JSON_BINARY 1
+#endif
+
+// blob argument is stored as
+//   binary                  : Bson, CBOR, MessagePack (binary type of each format)
+//   array of uint8          : UBJson (no binary type)
+//   {"base64": "..."}       : Json
+//   string                  : files written by old version (truncated at NUL)
+
 namespace ofx {
     namespace RecordOsc {
         namespace detail {
@@ -21,6 +36,124 @@ namespace ofx {
                     std::uint32_t lower;
                 };
             };
+            
+            constexpr char base64_key[] = "base64";
+            
+            inline std::string base64_encode(const std::uint8_t *data, std::size_t size) {
+                static constexpr char table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+                std::string encoded;
+                encoded.reserve((size + 2) / 3 * 4);
+                std::size_t i = 0;
+                for(; i + 3 <= size; i += 3) {
+                    std::uint32_t bits = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+                    encoded.push_back(table[(bits >> 18) & 0x3F]);
+                    encoded.push_back(table[(bits >> 12) & 0x3F]);
+                    encoded.push_back(table[(bits >> 6) & 0x3F]);
+                    encoded.push_back(table[bits & 0x3F]);
+                }
+                if(i < size) {
+                    std::uint32_t bits = data[i] << 16;
+                    if(i + 1 < size) bits |= data[i + 1] << 8;
+                    encoded.push_back(table[(bits >> 18) & 0x3F]);
+                    encoded.push_back(table[(bits >> 12) & 0x3F]);
+                    encoded.push_back(i + 1 < size ? table[(bits >> 6) & 0x3F] : '=');
+                    encoded.push_back('=');
+                }
+                return encoded;
+            }
+            
+            // invalid characters are skipped
+            inline std::vector<std::uint8_t> base64_decode(const std::string &encoded) {
+                std::vector<std::uint8_t> decoded;
+                decoded.reserve(encoded.size() / 4 * 3);
+                std::uint32_t bits = 0;
+                int num_bits = 0;
+                for(auto c : encoded) {
+                    int value;
+                    if('A' <= c && c <= 'Z') value = c - 'A';
+                    else if('a' <= c && c <= 'z') value = c - 'a' + 26;
+                    else if('0' <= c && c <= '9') value = c - '0' + 52;
+                    else if(c == '+') value = 62;
+                    else if(c == '/') value = 63;
+                    else continue;
+                    bits = (bits << 6) | value;
+                    num_bits += 6;
+                    if(8 <= num_bits) {
+                        num_bits -= 8;
+                        decoded.push_back(static_cast<std::uint8_t>(bits >> num_bits));
+                    }
+                }
+                return decoded;
+            }
+            
+            inline ofJson blob_to_json(const ofBuffer &blob) {
+                auto data = reinterpret_cast<const std::uint8_t *>(blob.getData());
+#ifdef OFX_RECORD_OSC_HAS_JSON_BINARY
+                return ofJson::binary(std::vector<std::uint8_t>(data, data + blob.size()));
+#else
+                ofJson json = ofJson::object();
+                json[base64_key] = base64_encode(data, blob.size());
+                return json;
+#endif
+            }
+            
+            inline ofBuffer blob_from_json(const ofJson &json) {
+#ifdef OFX_RECORD_OSC_HAS_JSON_BINARY
+                if(json.is_binary()) {
+                    const auto &bytes = json.get_binary();
+                    return ofBuffer{reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+                }
+#endif
+                if(json.is_object()) {
+                    auto &&bytes = base64_decode(json.value(base64_key, std::string()));
+                    return ofBuffer{reinterpret_cast<const char *>(bytes.data()), bytes.size()};
+                }
+                if(json.is_array()) {
+                    std::vector<char> bytes;
+                    bytes.reserve(json.size());
+                    for(const auto &b : json) bytes.push_back(static_cast<char>(b.get<std::uint8_t>()));
+                    return ofBuffer{bytes.data(), bytes.size()};
+                }
+                auto &&str = json.get<std::string>();
+                return ofBuffer{str.c_str(), str.length()};
+            }
+            
+            // JSON has no binary type, binary blobs in sequence are replaced with {"base64": "..."}
+            inline void encode_blobs_for_json(ofJson &json) {
+#ifdef OFX_RECORD_OSC_HAS_JSON_BINARY
+                auto sequence = json.find("sequence");
+                if(sequence == json.end() || !sequence->is_array()) return;
+                for(auto &record : *sequence) {
+                    if(!record.is_array() || record.size() < 2) continue;
+                    auto args = record[1].find("args");
+                    if(args == record[1].end()) continue;
+                    for(std::size_t i = 1; i < args->size(); i += 2) {
+                        auto &arg = (*args)[i];
+                        if(!arg.is_binary()) continue;
+                        const auto &bytes = arg.get_binary();
+                        ofJson encoded = ofJson::object();
+                        encoded[base64_key] = base64_encode(bytes.data(), bytes.size());
+                        arg = std::move(encoded);
+                    }
+                }
+#endif
+            }
+            
+            inline bool has_binary_blobs(const ofJson &json) {
+#ifdef OFX_RECORD_OSC_HAS_JSON_BINARY
+                auto sequence = json.find("sequence");
+                if(sequence == json.end() || !sequence->is_array()) return false;
+                for(const auto &record : *sequence) {
+                    if(!record.is_array() || record.size() < 2) continue;
+                    auto args = record[1].find("args");
+                    if(args == record[1].end()) continue;
+                    for(std::size_t i = 1; i < args->size(); i += 2) {
+                        if((*args)[i].is_binary()) return true;
+                    }
+                }
+#endif
+                return false;
+            }
         };
     };
 };
@@ -74,8 +207,7 @@ inline void to_json(ofJson &json,
                 args.push_back(mess.getArgAsTimetag(i));
                 break;
             case OFXOSC_TYPE_BLOB:
-                /// TODO: incomplete implementation. base64like encoding or other is needed
-                args.push_back(mess.getArgAsBlob(i).getText());
+                args.push_back(ofx::RecordOsc::detail::blob_to_json(mess.getArgAsBlob(i)));
                 break;
             case OFXOSC_TYPE_RGBA_COLOR:
                 args.push_back(mess.getArgAsRgbaColor(i));
@@ -138,12 +270,9 @@ inline void from_json(const ofJson &json,
             case OFXOSC_TYPE_TIMETAG:
                 mess.addTimetagArg(arg.get<std::uint64_t>());
                 break;
-            case OFXOSC_TYPE_BLOB: {
-                /// TODO: incomplete implementation. base64like encoding or other is needed
-                auto &&str = arg.get<std::string>();
-                mess.addBlobArg(ofBuffer{str.c_str(), str.length()});
+            case OFXOSC_TYPE_BLOB:
+                mess.addBlobArg(ofx::RecordOsc::detail::blob_from_json(arg));
                 break;
-            }
             case OFXOSC_TYPE_RGBA_COLOR:
                 mess.addTimetagArg(arg.get<std::uint32_t>());
                 break;
@@ -11,6 +11,12 @@
 
 #include "ofxOscMessageExJsonConversion.h"
 #include "ofxRecordOscData.h"
+#include "ofxRecordOscRingBuffer.h"
+#include "ofxRecordOscAddressFilter.h"
+#include "ofxRecordOscSession.h"
+#include "ofxRecordOscMetrics.h"
+#include "ofxRecordOscLiveStats.h"
+#include "ofxRecordOscRawSocket.h"
 
 #include "ofxPubSubOsc.h"
 
@@ -20,18 +26,193 @@
 
 #include "ofLog.h"
 
+#include <future>
+#include <deque>
+#include <functional>
+#include <condition_variable>
+
 namespace ofx {
     namespace RecordOsc {
+        namespace detail {
+            // slot of save_queue, owned and reused by the queue.
+            // message from listen or packet from listenRaw is written into it as OSC bytes on receiving thread,
+            // so buffers are reserved once (Recorder::setup) and receiving doesn't allocate per message.
+            // a message larger than reserved_bytes grows the slot once, and the slot keeps the capacity.
+            struct queued_data {
+                static constexpr std::size_t reserved_bytes = 256;
+                static constexpr std::size_t reserved_host_length = 64;
+
+                std::int64_t offset_ns{0};
+                std::string host;                // remote host
+                std::uint16_t port{0};           // remote port
+                std::uint16_t received_port{0};
+                bool is_packet{false};           // datagram of listenRaw, otherwise one message
+                std::vector<std::uint8_t> bytes;
+
+                void reserve() {
+                    host.reserve(reserved_host_length);
+                    bytes.reserve(reserved_bytes);
+                }
+            };
+            
+            // framed records converted by a worker, in increasing order of sequence number
+            struct record_batch {
+                struct span {
+                    std::uint64_t sequence;
+                    std::size_t position;
+                    std::size_t size;
+                    std::size_t num_messages;
+                    bool is_packet;
+                };
+                
+                std::vector<std::uint8_t> bytes;
+                std::vector<span> spans;
+                std::size_t cursor{0};
+                
+                // bytes of packet are copied as is, message is converted into record
+                void add(std::uint64_t sequence,
+                         const queued_data &queued,
+                         native::intern_cache &cache)
+                {
+                    auto position = bytes.size();
+                    osc::message_view message;
+                    if(!queued.is_packet && osc::read_message(queued.bytes.data(), queued.bytes.size(), 0, message)) {
+                        native::write_record(bytes, queued.offset_ns, message, queued.host, queued.port, queued.received_port, cache);
+                        spans.push_back({sequence, position, bytes.size() - position, 1, false});
+                        return;
+                    }
+                    // message which can't be read back (e.g. address without '/') is kept as packet
+                    auto num_messages = native::write_packet(bytes,
+                                                             queued.offset_ns,
+                                                             queued.bytes.data(),
+                                                             queued.bytes.size(),
+                                                             queued.host,
+                                                             queued.port,
+                                                             queued.received_port,
+                                                             cache);
+                    spans.push_back({sequence, position, bytes.size() - position, num_messages, true});
+                }
+                
+                std::size_t size() const
+                { return spans.size(); };
+                
+                bool exhausted() const
+                { return cursor == spans.size(); };
+                
+                void clear() {
+                    bytes.clear();
+                    spans.clear();
+                    cursor = 0;
+                }
+            }; // struct record_batch
+            
+            // merges batches from workers and passes records to writer in order of sequence number
+            struct reorder_buffer {
+                void reset(std::uint64_t first_sequence) {
+                    next_sequence = first_sequence;
+                    for(auto &batch : pending) recycle(batch);
+                    pending.clear();
+                }
+                
+                // batch is replaced by recycled empty one
+                void push(record_batch &batch, NativeWriter &writer) {
+                    pending.push_back(std::move(batch));
+                    if(recycled.empty()) {
+                        batch = record_batch{};
+                    } else {
+                        batch = std::move(recycled.back());
+                        recycled.pop_back();
+                    }
+                    drain(writer);
+                }
+                
+                // number of records (and packets) passed to writer since reset
+                std::uint64_t numDrainedRecords() const
+                { return next_sequence; };
+                
+                std::size_t numPendingRecords() const {
+                    std::size_t num = 0;
+                    for(const auto &batch : pending) num += batch.size() - batch.cursor;
+                    return num;
+                }
+                
+            private:
+                std::uint64_t next_sequence{0};
+                std::vector<record_batch> pending;
+                std::vector<record_batch> recycled;
+                
+                void drain(NativeWriter &writer) {
+                    bool progress = true;
+                    while(progress) {
+                        progress = false;
+                        for(auto &batch : pending) {
+                            // append contiguous run of same kind at once
+                            auto begin = batch.cursor;
+                            std::size_t num_messages = 0;
+                            while(!batch.exhausted()
+                                  && batch.spans[batch.cursor].sequence == next_sequence
+                                  && batch.spans[batch.cursor].is_packet == batch.spans[begin].is_packet)
+                            {
+                                num_messages += batch.spans[batch.cursor].num_messages;
+                                ++batch.cursor;
+                                ++next_sequence;
+                            }
+                            if(begin == batch.cursor) continue;
+                            const auto &first = batch.spans[begin];
+                            const auto &last = batch.spans[batch.cursor - 1];
+                            if(writer.isOpen()) {
+                                auto data = batch.bytes.data() + first.position;
+                                auto size = last.position + last.size - first.position;
+                                if(first.is_packet) writer.appendPackets(data, size, num_messages);
+                                else writer.append(data, size, batch.cursor - begin);
+                            }
+                            progress = true;
+                        }
+                    }
+                    auto it = std::remove_if(pending.begin(),
+                                             pending.end(),
+                                             [this](record_batch &batch) {
+                                                 if(!batch.exhausted()) return false;
+                                                 recycle(batch);
+                                                 return true;
+                                             });
+                    pending.erase(it, pending.end());
+                }
+                
+                void recycle(record_batch &batch) {
+                    batch.clear();
+                    recycled.push_back(std::move(batch));
+                }
+            }; // struct reorder_buffer
+        }; // namespace detail
+        
+        // result of saving a recording. see Recorder::stopRecordingAsync
+        struct SaveResult {
+            bool succeeded{false};
+            std::string path;              // saved file or session directory
+            FileFormat format{FileFormat::Native};
+            std::uint64_t num_records{0};
+            std::uint64_t num_dropped{0};  // dropped because queue was full
+            double duration_sec{0.0};      // length of recording
+            double save_duration_ms{0.0};  // from stop to end of saving
+        }; // struct SaveResult
+        
         struct Recorder {
-            using clock = std::chrono::high_resolution_clock;
+            using clock = std::chrono::steady_clock;
             
             void setup(const std::string &rec_start_address = "",
                        const std::string &rec_stop_address = "",
-                       std::size_t num_subprocess = 8)
+                       std::size_t num_subprocess = 8,
+                       std::size_t queue_capacity = 65536)
             {
                 if(rec_start_address != "") metadata.system_message.recording_start = rec_start_address;
                 if(rec_stop_address != "") metadata.system_message.recording_stop = rec_stop_address;
+                save_queue.resize(queue_capacity);
+                // receiving threads write into these buffers without allocating
+                save_queue.forEachSlot([](detail::queued_data &queued) { queued.reserve(); });
+                resetMetrics();
                 setupSubProcesses(num_subprocess);
+                setupFinalizer();
                 auto &&events = ofEvents();
                 ofAddListener(events.update,
                               this,
@@ -47,39 +228,140 @@ namespace ofx {
                 format = file_format;
             }
             
+            // splits recording into segments of Native format in session directory
+            // when current segment reaches duration [sec] or size [byte]. 0 disables each limit.
+            // session can be opened by Player::setupSession as one timeline.
+            void setSegmentRotation(double max_duration_sec, std::uint64_t max_bytes = 0) {
+                auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                segment_duration_ns = std::llround(max_duration_sec * 1000000000.0);
+                segment_size = max_bytes;
+            }
+            
+            // compression of records in Native spool / segments. see Compression
+            void setCompression(Compression compression) {
+                auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                writer.setCompression(compression);
+            }
+            
+            bool isSegmentRotationEnabled() const
+            { return 0 < segment_duration_ns || 0 < segment_size; };
+            
             bool startRecording(decltype(clock::now()) now) {
                 if(is_recording_now) {
                     ofLogWarning("ofxOscRecorder") << "already recording is started.";
                     return false;
                 }
+                // writer and queue are reused, so previous take must be closed.
+                // it waits only draining of queue, not converting / saving of file.
+                while(0 < num_closing_takes) {
+                    take_closed_signal.wait([this] { return num_closing_takes == 0; },
+                                            std::chrono::milliseconds(100));
+                }
                 metadata.start();
                 start = now;
                 trashQueue();
-                osc_sequence = ofJson::array();
+                live_stats.reset();
+                // sequence number of message is (ticket of save_queue - sequence_origin)
+                sequence_origin = save_queue.numPushed();
+                {
+                    auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                    reorder.reset(0);
+                    num_written = 0;
+                    num_dropped_at_start = num_dropped;
+                    // previous take can be still converted from its spool, so number of take is added
+                    auto &&spool_prefix = ofToDataPath(ofVAArgsToString("osc_sequence-%s-%llu.part",
+                                                                        ofGetTimestampString("%Y%m%d-%H%M%S").c_str(),
+                                                                        static_cast<unsigned long long>(num_takes++)),
+                                                       true);
+                    if(isSegmentRotationEnabled()) {
+                        if(format != FileFormat::Native) {
+                            ofLogNotice("ofxOscRecorder") << "segments are written by Native format.";
+                        }
+                        session_directory = spool_prefix;
+                        if(!ofDirectory::doesDirectoryExist(session_directory, false)
+                           && !ofDirectory::createDirectory(session_directory, false, true))
+                        {
+                            ofLogError("ofxOscRecorder") << "can't create session directory: " << session_directory;
+                            return false;
+                        }
+                        manifest = SessionManifest{};
+                        manifest.metadata = metadata;
+                        manifest.segments.emplace_back();
+                        manifest.segments.back().filename = SessionManifest::segmentFilename(0);
+                        spool_path = ofFilePath::join(session_directory, manifest.segments.back().filename);
+                        segment_started = now;
+                    } else {
+                        session_directory.clear();
+                        spool_path = spool_prefix + "." + RecordOsc::detail::to_ext(FileFormat::Native);
+                    }
+                    if(!writer.open(spool_path, metadata)) {
+                        ofLogError("ofxOscRecorder") << "can't start recording.";
+                        return false;
+                    }
+                    if(!session_directory.empty()) manifest.save(session_directory);
+                }
                 is_recording_now = true;
                 return true;
             }
             
+            // blocks until the recording is saved
             bool stopRecording(const std::string &filename_prefix = "") {
                 if(!isRecordingNow()) {
                     ofLogWarning("ofxOscRecorder") << "recording is not started.";
                     return false;
                 }
-                
-                is_recording_now = false;
-                while(!save_queue.empty()) ofSleepMillis(1);
-                auto duration = clock::now() - start;
-                double duration_ms = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() / 1000.0;
-                metadata.finish(duration_ms);
-                saveData(filename_prefix);
+                stopRecordingAsync(filename_prefix).wait();
                 return true;
             }
             
+            // returns immediately. remaining messages are written and the file is saved by background thread,
+            // and result is passed to future, callback and callback of setSaveCallback (on background thread).
+            // next recording can be started as soon as remaining messages are written,
+            // before converting / saving of previous file is finished.
+            std::shared_future<SaveResult> stopRecordingAsync(const std::string &filename_prefix = "",
+                                                              std::function<void(const SaveResult &)> callback = nullptr)
+            {
+                auto promise = std::make_shared<std::promise<SaveResult>>();
+                auto future = promise->get_future().share();
+                bool recording = true;
+                if(!is_recording_now.compare_exchange_strong(recording, false)) {
+                    ofLogWarning("ofxOscRecorder") << "recording is not started.";
+                    promise->set_value(SaveResult{});
+                    return future;
+                }
+                auto stopped = clock::now();
+                ++num_closing_takes;
+                enqueueFinalizerJob([=] {
+                    auto &&result = finishTake(filename_prefix, stopped);
+                    last_save_duration_ns = std::llround(result.save_duration_ms * 1000000.0);
+                    promise->set_value(result);
+                    if(callback) callback(result);
+                    std::function<void(const SaveResult &)> save_callback;
+                    {
+                        auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                        save_callback = this->save_callback;
+                    }
+                    if(save_callback) save_callback(result);
+                });
+                return future;
+            }
+            
+            // called on background thread after each recording is saved,
+            // including recordings stopped by stop message
+            void setSaveCallback(std::function<void(const SaveResult &)> callback) {
+                auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                save_callback = callback;
+            }
+            
             void listen(std::uint16_t port) {
                 if(!metadata.addListeningPort(port)) {
                     ofLogWarning("ofxOscRecorder") << "port " << port << " is already listening.";
                 }
+                // decisions of filter are cached per port, receiving thread of port only touches it
+                auto filter_cache = std::make_shared<AddressFilter::Cache>();
+                auto stats_cache = std::make_shared<LiveAddressStats::Cache>();
                 ofxSubscribeAllOscForPort(port, [=] (const ofxOscMessageEx &m, bool b) {
+                    // capture time before anything
                     auto now = clock::now();
                     auto &&address = m.getAddress();
                     if(address == metadata.system_message.recording_start) {
@@ -89,11 +371,45 @@ namespace ofx {
                     if(!isRecordingNow()) return;
                     
                     // message for recording
-                    if(!is_allow(m)) return;
-                    auto offset = now - start;
-                    double offset_ms = std::chrono::duration_cast<std::chrono::milliseconds>(offset).count() / 1000.0;
-                    save_queue.send({offset_ms, m});
-                    digests.push_back(ofVAArgsToString("%6.3f: %s [%ld]", offset_ms, m.getAddress().c_str(), m.getNumArgs()));
+                    ++num_received;
+                    auto allowed = address_filter.isAllowed(address, *filter_cache);
+                    filter_latency.record(detail::elapsed_nanos(now, clock::now()));
+                    if(!allowed) {
+                        ++num_filtered;
+                        return;
+                    }
+                    auto offset_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+                    auto record_offset_ns = offset_ns;
+                    if(custom_time_calculator) {
+                        record_offset_ns = std::llround(custom_time_calculator(m, offset_ns / 1000000000.0) * 1000000000.0);
+                    }
+                    ++num_pending;
+                    if(!isRecordingNow()) {
+                        // stopRecording is called by other port while receiving
+                        --num_pending;
+                        return;
+                    }
+                    // message is written into slot of queue as OSC bytes. ofxOsc doesn't pass timetag of bundle
+                    std::uint64_t ticket;
+                    auto pushed = save_queue.pushWith([&](detail::queued_data &queued) {
+                        queued.offset_ns = record_offset_ns;
+                        queued.host.assign(m.getRemoteHost());
+                        queued.port = static_cast<std::uint16_t>(m.getRemotePort());
+                        queued.received_port = m.getWaitingPort();
+                        queued.is_packet = false;
+                        queued.bytes.clear();
+                        detail::osc::write_message(queued.bytes, m);
+                    }, ticket);
+                    if(!pushed) {
+                        --num_pending;
+                        ++num_dropped;
+                        return;
+                    }
+                    save_signal.notify();
+                    ++num_accepted;
+                    receive_latency.record(detail::elapsed_nanos(now, clock::now()));
+                    digests.push(offset_ns, address, m.getNumArgs());
+                    live_stats.add(address, m, offset_ns, *stats_cache);
                     
                     if(address == metadata.system_message.recording_stop) {
                         std::string filename_prefix = "osc_sequence";
@@ -104,13 +420,98 @@ namespace ofx {
                         {
                             filename_prefix = m.getArgAsString(0);
                         }
-                        stopRecording(filename_prefix);
+                        // receiving thread is not blocked by saving
+                        stopRecordingAsync(filename_prefix);
                     }
                 });
             }
             
+            // records received datagrams of port as is, instead of parsed messages.
+            // bundles are kept and timetags are restored on playback,
+            // cost of receiving is a copy of datagram. (see Player::playPackets)
+            // port must not be subscribed by ofxPubSubOsc / ofxOscReceiver.
+            // whitelists / blacklists are applied per packet: packet is recorded if any message is allowed.
+            // custom time calculator is not applied.
+            bool listenRaw(std::uint16_t port) {
+                if(!metadata.addListeningPort(port)) {
+                    ofLogWarning("ofxOscRecorder") << "port " << port << " is already listening.";
+                }
+                auto receiver = std::make_shared<detail::raw_receiver>();
+                // only touched by receiving thread of port
+                auto state = std::make_shared<raw_port_state>();
+                auto success = receiver->setup(port, [=](const std::uint8_t *bytes, std::size_t size, const std::string &host, std::uint16_t remote_port) {
+                    receivePacket(bytes, size, host, remote_port, port, *state);
+                });
+                if(!success) return false;
+                raw_receivers.push_back(receiver);
+                return true;
+            }
+            
+#pragma mark metrics
+            
+            // lock-free snapshot, can be called from any thread
+            RecorderMetrics getMetrics() const {
+                RecorderMetrics metrics;
+                metrics.num_received = num_received;
+                metrics.num_filtered = num_filtered;
+                metrics.num_accepted = num_accepted;
+                metrics.num_dropped = num_dropped - num_dropped_at_reset;
+                metrics.num_written = num_written;
+                metrics.num_rotations = num_rotations;
+                metrics.queue_depth = save_queue.size();
+                metrics.queue_capacity = save_queue.capacity();
+                auto elapsed_ns = detail::elapsed_nanos(clock::time_point{}, clock::now()) - metrics_reset_at;
+                metrics.elapsed_sec = elapsed_ns / 1000000000.0;
+                if(0 < elapsed_ns && !process_threads.empty()) {
+                    metrics.worker_utilization = static_cast<double>(worker_busy_ns) / elapsed_ns / process_threads.size();
+                }
+                metrics.receive = receive_latency.snapshot();
+                metrics.filter = filter_latency.snapshot();
+                metrics.convert = convert_latency.snapshot();
+                metrics.write = write_latency.snapshot();
+                metrics.last_save_duration_ms = last_save_duration_ns / 1000000.0;
+                return metrics;
+            }
+            
+            // numWrittenMessages and numDroppedMessages are not reset
+            void resetMetrics() {
+                num_received = 0;
+                num_filtered = 0;
+                num_accepted = 0;
+                num_dropped_at_reset = num_dropped.load();
+                num_rotations = 0;
+                worker_busy_ns = 0;
+                receive_latency.reset();
+                filter_latency.reset();
+                convert_latency.reset();
+                write_latency.reset();
+                metrics_reset_at = detail::elapsed_nanos(clock::time_point{}, clock::now());
+            }
+            
+            // sends metrics to host:port every interval_sec on update.
+            //   PREFIX/counts [received, filtered, accepted, dropped, written]
+            //   PREFIX/queue [depth, capacity]
+            //   PREFIX/worker_utilization [ratio]
+            //   PREFIX/latency/{receive,filter,convert,write} [count, mean, p50, p99, max] (microsec)
+            //   PREFIX/last_save_duration_ms [ms]
+            void publishMetrics(const std::string &host,
+                                std::uint16_t port,
+                                double interval_sec = 1.0,
+                                const std::string &address_prefix = "/ofxRecordOsc/metrics")
+            {
+                metrics_host = host;
+                metrics_port = port;
+                metrics_interval = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(interval_sec));
+                metrics_prefix = address_prefix;
+                metrics_published_at = clock::now();
+            }
+            
+            void stopPublishingMetrics()
+            { metrics_port = 0; };
+            
 #pragma mark custom time calculator
             
+            // calculator is called on receiving thread of each port
             void setCustomTimeCalculator(std::function<double(const ofxOscMessageEx &, double)> calculator, bool need_mutex = false) {
                 if(need_mutex) {
                     custom_time_calculator = [=] (const ofxOscMessageEx &m, double t)
@@ -125,106 +526,424 @@ namespace ofx {
             
 #pragma mark whitelist / blacklist
             
-            void addWhitelist(const std::string &address)
-            { metadata.addWhitelist(address); };
+            // address can be OSC address pattern. e.g. /sensor/*/accel, /note/{on,off}, /ch[1-4]
+            void addWhitelist(const std::string &address) {
+                metadata.addWhitelist(address);
+                updateAddressFilter();
+            }
             
             template <typename string_container>
-            void addWhitelists(const string_container &addresses)
-            { metadata.addWhitelists(addresses); };
+            void addWhitelists(const string_container &addresses) {
+                metadata.addWhitelists(addresses);
+                updateAddressFilter();
+            }
             
             void printWhitelists() const
             { metadata.printWhitelists(); };
             
-            void clearWhitelists()
-            { metadata.clearWhitelists(); };
+            void clearWhitelists() {
+                metadata.clearWhitelists();
+                updateAddressFilter();
+            }
             
-            void addBlacklist(const std::string &address)
-            { metadata.addBlacklist(address); };
+            void addBlacklist(const std::string &address) {
+                metadata.addBlacklist(address);
+                updateAddressFilter();
+            }
             
             template <typename string_container>
-            void addBlacklists(const string_container &addresses)
-            { metadata.addBlacklists(addresses); };
+            void addBlacklists(const string_container &addresses) {
+                metadata.addBlacklists(addresses);
+                updateAddressFilter();
+            }
             
             void printBlacklists() const
             { metadata.printBlacklists(); };
             
-            void clearBlacklists()
-            { metadata.clearBlacklists(); };
+            void clearBlacklists() {
+                metadata.clearBlacklists();
+                updateAddressFilter();
+            }
 
 #pragma mark -
             
             void update(ofEventArgs &) {
-                if(digest_length < digests.size()) {
-                    digests.erase(digests.begin(),
-                                  digests.begin() + digests.size() - 100);
+                if(0 < metrics_port && metrics_interval <= clock::now() - metrics_published_at) {
+                    metrics_published_at = clock::now();
+                    for(const auto &m : detail::to_messages(metrics_prefix, getMetrics())) {
+                        ofxSendOsc(metrics_host, metrics_port, m);
+                    }
                 }
             }
             
             bool isRecordingNow() const
             { return is_recording_now; };
             
+            std::uint64_t numDroppedMessages() const
+            { return num_dropped; };
+            
+            // messages accepted but not passed to writer yet (in queue or converting)
+            std::size_t numPendingMessages() const
+            { return num_pending; };
+            
+            // messages (or raw packets) appended to writer in current recording
+            std::uint64_t numWrittenMessages() const
+            { return num_written; };
+            
+            // path of file (or session directory) saved by last stopRecording. empty if it was failed
+            std::string lastSavedPath() {
+                auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                return last_saved_path;
+            }
+            
+            // latest accepted messages, newest first. formatted only here
             std::string digestString() const {
-                return std::accumulate(digests.crbegin(),
-                                       digests.crend(),
-                                       std::string{""},
-                                       [] (std::string res, const std::string &add) {
-                                           return res + add + "\n";
-                                       });
+                std::string result;
+                forEachDigest([&result](const Digest &digest) {
+                    result += ofVAArgsToString("%6.3f: %s [%d]", digest.offset(), digest.address.c_str(), static_cast<int>(digest.num_args));
+                    result += "\n";
+                });
+                return result;
             };
             
-            void saveData(const std::string &fileprefix) {
-                auto &&_ = std::lock_guard<decltype(osc_sequence_mutex)>(osc_sequence_mutex);
-                ofJson save_data = ofJson::object();
-                save_data["metadata"] = metadata;
-                save_data["sequence"] = std::move(osc_sequence);
-                auto ext = RecordOsc::detail::to_ext(format);
-                auto filepath = ofToDataPath(fileprefix + "-" + ofGetTimestampString("%Y%m%d-%H%M%S") + "." + ext, true);
-                auto success = RecordOsc::detail::save(filepath, save_data, format);
-                if(success) {
-                    ofLogNotice("ofxOscRecorder") << "finished to save data to " << filepath;
-                } else {
-                    ofLogError("ofxOscRecorder") << "failed to save data to " << filepath;
-                }
-                osc_sequence = ofJson();
-                trashQueue();
-            };
+            // callback: void(const Digest &). newest first
+            template <typename callback_t>
+            void forEachDigest(callback_t callback) const
+            { digests.forEachLatest(digest_length, callback); };
+            
+            // count / rate / last value per address of current recording.
+            // rate is measured from previous call, so call this periodically (e.g. on update)
+            std::vector<AddressStats> getAddressStats()
+            { return live_stats.snapshot(); };
             
             void exit(ofEventArgs &) {
+                for(auto &receiver : raw_receivers) receiver->stop();
                 if(isRecordingNow()) {
                     stopRecording("autosave-on-exit");
                 }
+                // finish saving of all stopped recordings before workers stop
+                {
+                    auto &&_ = std::lock_guard<decltype(finalizer_mutex)>(finalizer_mutex);
+                    is_finalizer_running = false;
+                }
+                finalizer_condition.notify_all();
+                if(finalizer_thread.joinable()) finalizer_thread.join();
                 is_running = false;
+                save_signal.notifyAll();
                 for(auto &th : process_threads) th.join();
             }
         private:
-            bool is_recording_now{false};
+            std::atomic_bool is_recording_now{false};
 
             FileFormat format{FileFormat::Json};
             
             clock::time_point start;
-            std::mutex osc_sequence_mutex;
-            ofJson osc_sequence;
+            std::mutex writer_mutex;
+            NativeWriter writer;
+            detail::reorder_buffer reorder;
+            std::uint64_t sequence_origin{0};
+            std::string spool_path;
+            std::string last_saved_path;
             Metadata metadata;
+            
+            // segment rotation. guarded by writer_mutex
+            std::int64_t segment_duration_ns{0};
+            std::uint64_t segment_size{0};
+            std::string session_directory; // empty if rotation is disabled
+            SessionManifest manifest;
+            clock::time_point segment_started;
+            
+            // stopped but not closed recordings. startRecording waits them
+            std::atomic<std::size_t> num_closing_takes{0};
+            WakeupSignal take_closed_signal;
+            std::uint64_t num_dropped_at_start{0};
+            std::uint64_t num_takes{0};
+            std::function<void(const SaveResult &)> save_callback; // guarded by writer_mutex
+            
+            // saving runs on this thread in order of stop
+            std::thread finalizer_thread;
+            std::mutex finalizer_mutex;
+            std::condition_variable finalizer_condition;
+            std::deque<std::function<void()>> finalizer_jobs;
+            bool is_finalizer_running{false};
+            
+            void setupFinalizer() {
+                is_finalizer_running = true;
+                finalizer_thread = std::thread([this] {
+#ifdef TARGET_OSX
+                    pthread_setname_np("oscrec-finalizer");
+#endif
+                    while(true) {
+                        std::function<void()> job;
+                        {
+                            std::unique_lock<decltype(finalizer_mutex)> lock(finalizer_mutex);
+                            finalizer_condition.wait(lock, [this] { return !finalizer_jobs.empty() || !is_finalizer_running; });
+                            if(finalizer_jobs.empty()) break;
+                            job = std::move(finalizer_jobs.front());
+                            finalizer_jobs.pop_front();
+                        }
+                        job();
+                    }
+                });
+            }
+            
+            void enqueueFinalizerJob(std::function<void()> job) {
+                {
+                    auto &&_ = std::lock_guard<decltype(finalizer_mutex)>(finalizer_mutex);
+                    finalizer_jobs.push_back(std::move(job));
+                }
+                finalizer_condition.notify_one();
+            }
+            
+            // on finalizer thread
+            SaveResult finishTake(const std::string &fileprefix, clock::time_point stopped) {
+                SaveResult result;
+                result.format = isSegmentRotationEnabled() ? FileFormat::Native : format;
+                // wait until all accepted messages are passed to writer
+                while(0 < num_pending) {
+                    drain_signal.wait([this] { return num_pending == 0; },
+                                      std::chrono::milliseconds(100));
+                }
+                std::string converting_path;
+                {
+                    auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                    result.num_dropped = num_dropped - num_dropped_at_start;
+                    if(0 < result.num_dropped) {
+                        ofLogWarning("ofxOscRecorder") << result.num_dropped << " messages were dropped because queue was full.";
+                    }
+                    metadata.finishNanos(detail::elapsed_nanos(start, stopped));
+                    result.duration_sec = metadata.duration;
+                    converting_path = closeTake(fileprefix, result);
+                    trashQueue();
+                }
+                // next recording can start from here
+                --num_closing_takes;
+                take_closed_signal.notifyAll();
+                
+                if(!converting_path.empty()) {
+                    auto &&save_data = RecordOsc::detail::load(converting_path, FileFormat::Native);
+                    result.succeeded = RecordOsc::detail::save(result.path, std::move(save_data), result.format);
+                    if(result.succeeded) {
+                        std::remove(converting_path.c_str());
+                    } else {
+                        ofLogError("ofxOscRecorder") << "failed to save data to " << result.path << ". recorded data is remained at " << converting_path;
+                    }
+                }
+                if(result.succeeded) {
+                    ofLogNotice("ofxOscRecorder") << "finished to save data to " << result.path;
+                }
+                result.save_duration_ms = detail::elapsed_nanos(stopped, clock::now()) / 1000000.0;
+                {
+                    auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                    last_saved_path = result.succeeded ? result.path : "";
+                }
+                return result;
+            }
+            
+            // called with writer_mutex. returns path of spool file if it has to be converted to other format
+            std::string closeTake(const std::string &fileprefix, SaveResult &result) {
+                if(!writer.isOpen()) {
+                    ofLogWarning("ofxOscRecorder") << "no recording data to save.";
+                    return "";
+                }
+                if(!session_directory.empty()) {
+                    closeSession(fileprefix, result);
+                    return "";
+                }
+                result.num_records = writer.numRecords();
+                auto closed = writer.close(metadata);
+                auto ext = RecordOsc::detail::to_ext(format);
+                result.path = ofToDataPath(fileprefix + "-" + ofGetTimestampString("%Y%m%d-%H%M%S") + "." + ext, true);
+                if(format != FileFormat::Native) return spool_path;
+                // recorded data is already on the disk, only rename it.
+                result.succeeded = closed && std::rename(spool_path.c_str(), result.path.c_str()) == 0;
+                if(!result.succeeded) {
+                    ofLogError("ofxOscRecorder") << "failed to save data to " << result.path << ". recorded data is remained at " << spool_path;
+                }
+                return "";
+            }
+            
+            // with segment rotation, session directory is renamed instead of file
+            void closeSession(const std::string &fileprefix, SaveResult &result) {
+                updateCurrentSegment();
+                auto success = writer.close(metadata);
+                manifest.segments.back().finalized = success;
+                manifest.metadata = metadata;
+                manifest.finalized = true;
+                result.num_records = manifest.numRecords();
+                success = manifest.save(session_directory) && success;
+                result.path = ofToDataPath(fileprefix + "-" + ofGetTimestampString("%Y%m%d-%H%M%S"), true);
+                result.succeeded = success && std::rename(session_directory.c_str(), result.path.c_str()) == 0;
+                if(!result.succeeded) {
+                    ofLogError("ofxOscRecorder") << "failed to save session to " << result.path << ". recorded data is remained at " << session_directory;
+                }
+                session_directory.clear();
+            }
+            
+            void updateCurrentSegment() {
+                auto &&segment = manifest.segments.back();
+                segment.num_records = writer.numRecords();
+                segment.first_offset_ns = writer.firstOffsetNanos();
+                segment.last_offset_ns = writer.lastOffsetNanos();
+            }
+            
+            // called with writer_mutex after records are appended.
+            // receiving threads are not blocked because they only push to save_queue.
+            void rotateSegmentIfNeeded() {
+                if(session_directory.empty() || !writer.isOpen() || writer.numRecords() == 0) return;
+                auto now = clock::now();
+                bool by_size = 0 < segment_size && segment_size <= writer.numBytes();
+                bool by_duration = 0 < segment_duration_ns
+                                && segment_duration_ns <= std::chrono::duration_cast<std::chrono::nanoseconds>(now - segment_started).count();
+                if(!by_size && !by_duration) return;
+                
+                Metadata segment_metadata = metadata;
+                segment_metadata.finishNanos(std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count());
+                updateCurrentSegment();
+                SegmentInfo next;
+                next.filename = SessionManifest::segmentFilename(manifest.segments.size());
+                auto success = writer.rotate(ofFilePath::join(session_directory, next.filename),
+                                             segment_metadata,
+                                             metadata);
+                manifest.segments.back().finalized = true;
+                manifest.segments.push_back(next);
+                if(!success) {
+                    ofLogError("ofxOscRecorder") << "failed to rotate segment to " << next.filename;
+                }
+                manifest.save(session_directory);
+                segment_started = now;
+                ++num_rotations;
+            }
             std::atomic_bool is_running;
             std::vector<std::thread> process_threads;
             
             std::function<double(const ofxOscMessageEx &, double)> custom_time_calculator;
             std::mutex custom_time_calculator_mutex;
 
-            bool is_allow(const ofxOscMessageEx &m) {
-                if(metadata.whitelists.size()) {
-                    if(metadata.whitelists.find(m.getAddress()) == metadata.whitelists.end()) return false;
-                }
-                if(metadata.blacklists.size()) {
-                    if(metadata.blacklists.find(m.getAddress()) != metadata.blacklists.end()) return false;
-                }
-                return true;
-            }
+            // compiled from metadata.whitelists / blacklists.
+            // receiving threads refer only this, not metadata.
+            AddressFilter address_filter;
+            
+            void updateAddressFilter()
+            { address_filter.setup(metadata.whitelists, metadata.blacklists); };
 
-            ofThreadChannel<SequenceData> save_queue;
-            std::vector<std::string> digests;
+            RingBuffer<detail::queued_data> save_queue;
+            WakeupSignal save_signal;
+            WakeupSignal drain_signal;
+            std::atomic<std::size_t> num_pending{0};
+            std::atomic<std::uint64_t> num_dropped{0};
+            std::atomic<std::uint64_t> num_written{0};
+            
+            // metrics
+            std::atomic<std::uint64_t> num_received{0};
+            std::atomic<std::uint64_t> num_filtered{0};
+            std::atomic<std::uint64_t> num_accepted{0};
+            std::atomic<std::uint64_t> num_dropped_at_reset{0};
+            std::atomic<std::uint64_t> num_rotations{0};
+            std::atomic<std::int64_t> worker_busy_ns{0};
+            std::atomic<std::int64_t> metrics_reset_at{0}; // nanosec from epoch of clock
+            std::atomic<std::int64_t> last_save_duration_ns{0};
+            LatencyHistogram receive_latency;
+            LatencyHistogram filter_latency;
+            LatencyHistogram convert_latency;
+            LatencyHistogram write_latency;
+            // publishing. only touched by main thread
+            std::string metrics_host;
+            std::uint16_t metrics_port{0};
+            clock::duration metrics_interval;
+            std::string metrics_prefix;
+            clock::time_point metrics_published_at;
+            std::size_t worker_batch_size{16 * 1024};
+            DigestRing digests{128};
             std::size_t digest_length{100};
+            LiveAddressStats live_stats;
 
+            // raw capture
+            struct raw_port_state {
+                AddressFilter::Cache filter_cache;
+                LiveAddressStats::Cache stats_cache;
+                std::string address; // reused buffer
+            };
+            std::vector<std::shared_ptr<detail::raw_receiver>> raw_receivers;
+            
+            // on receiving thread of raw port
+            void receivePacket(const std::uint8_t *bytes,
+                               std::size_t size,
+                               const std::string &host,
+                               std::uint16_t remote_port,
+                               std::uint16_t received_port,
+                               raw_port_state &state)
+            {
+                // capture time before anything
+                auto now = clock::now();
+                bool has_start = false, has_stop = false, has_message = false, allowed = false;
+                std::string filename_prefix = "osc_sequence";
+                detail::osc::for_each_message(bytes, size, [&](const detail::osc::message_view &m) {
+                    has_message = true;
+                    if(m.isAddress(metadata.system_message.recording_start)) {
+                        has_start = true;
+                        return;
+                    }
+                    if(m.isAddress(metadata.system_message.recording_stop)) {
+                        has_stop = true;
+                        if(0 < m.num_typetags
+                           && (m.typetags[0] == OFXOSC_TYPE_STRING || m.typetags[0] == OFXOSC_TYPE_SYMBOL)
+                           && 0 < detail::osc::padded_string_size(m.arguments, m.end))
+                        {
+                            filename_prefix = reinterpret_cast<const char *>(m.arguments);
+                        }
+                    }
+                    if(allowed || !isRecordingNow()) return;
+                    state.address.assign(m.address, m.address_length);
+                    allowed = address_filter.isAllowed(state.address, state.filter_cache);
+                });
+                // packet including start message is not recorded
+                if(has_start) {
+                    startRecording(now);
+                    return;
+                }
+                if(!isRecordingNow()) return;
+                
+                ++num_received;
+                // broken packet is recorded as is
+                allowed = allowed || !has_message;
+                filter_latency.record(detail::elapsed_nanos(now, clock::now()));
+                if(!allowed) {
+                    ++num_filtered;
+                    return;
+                }
+                auto offset_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+                ++num_pending;
+                if(!isRecordingNow()) {
+                    --num_pending;
+                    return;
+                }
+                // datagram is copied into slot of queue
+                std::uint64_t ticket;
+                auto pushed = save_queue.pushWith([&](detail::queued_data &queued) {
+                    queued.offset_ns = offset_ns;
+                    queued.host.assign(host);
+                    queued.port = remote_port;
+                    queued.received_port = received_port;
+                    queued.is_packet = true;
+                    queued.bytes.assign(bytes, bytes + size);
+                }, ticket);
+                if(!pushed) {
+                    --num_pending;
+                    ++num_dropped;
+                    return;
+                }
+                save_signal.notify();
+                ++num_accepted;
+                receive_latency.record(detail::elapsed_nanos(now, clock::now()));
+                detail::osc::for_each_message(bytes, size, [&](const detail::osc::message_view &m) {
+                    state.address.assign(m.address, m.address_length);
+                    digests.push(offset_ns, state.address, m.numArgs());
+                    live_stats.add(state.address, detail::osc::first_arg_as_double(m), offset_ns, state.stats_cache);
+                });
+                if(has_stop) stopRecordingAsync(filename_prefix);
+            }
+            
             void setupSubProcesses(std::size_t num_subprocess) {
                 process_threads.reserve(num_subprocess);
                 is_running = true;
@@ -233,33 +952,55 @@ namespace ofx {
 #ifdef TARGET_OSX
                         pthread_setname_np(ofVAArgsToString("oscrec-conv-%d", i).c_str());
 #endif
+                        // per-worker output buffer. it is merged into writer per batch
+                        // in order of sequence number.
+                        detail::record_batch batch;
+                        detail::native::intern_cache cache{writer.internTable()};
+                        auto flush_batch = [&] {
+                            auto num_records = batch.size();
+                            if(num_records == 0) return;
+                            auto writing = clock::now();
+                            {
+                                auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                                reorder.push(batch, writer);
+                                num_written = reorder.numDrainedRecords();
+                                rotateSegmentIfNeeded();
+                            }
+                            auto elapsed = detail::elapsed_nanos(writing, clock::now());
+                            write_latency.record(elapsed);
+                            worker_busy_ns += elapsed;
+                            if(num_pending.fetch_sub(num_records) == num_records) drain_signal.notifyAll();
+                        };
+                        
+                        std::uint64_t ticket;
+                        clock::time_point converting;
                         while(this->is_running) {
-                            if(!save_queue.empty()) {
-                                SequenceData data;
-                                save_queue.receive(data);
-                                const auto &mess = data.mess;
-                                ofJson &&json = ofJson::array();
-                                auto offset_ms = data.offset;
-                                if(custom_time_calculator) {
-                                    auto custom_ms = custom_time_calculator(mess, offset_ms);
-                                    json.push_back(custom_ms);
-                                } else {
-                                    json.push_back(offset_ms);
-                                }
-                                ofJson mess_json;
-                                to_json(mess_json, mess);
-                                json.push_back(mess_json);
-                                auto &&_ = std::lock_guard<decltype(osc_sequence_mutex)>(osc_sequence_mutex);
-                                if(!isRecordingNow()) continue;
-                                osc_sequence.push_back(std::move(json));
-                                std::this_thread::sleep_for(std::chrono::microseconds(10));
-                            } else {
-                                std::this_thread::sleep_for(std::chrono::milliseconds(3));
+                            // converted in place, slot is reused by receiving threads
+                            auto popped = save_queue.popWith([&](const detail::queued_data &queued) {
+                                converting = clock::now();
+                                batch.add(ticket - sequence_origin, queued, cache);
+                            }, ticket);
+                            if(popped) {
+                                auto elapsed = detail::elapsed_nanos(converting, clock::now());
+                                convert_latency.record(elapsed);
+                                worker_busy_ns += elapsed;
+                                if(worker_batch_size <= batch.bytes.size()) flush_batch();
+                                continue;
+                            }
+                            flush_batch();
+                            save_signal.wait([this] { return !save_queue.empty() || !is_running; },
+                                             std::chrono::milliseconds(50));
+                            if(save_queue.empty()) {
+                                // write pending records to disk while idle
+                                auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
+                                writer.flush();
+                                rotateSegmentIfNeeded();
                             }
                         }
+                        flush_batch();
 #if OFX_OSCRECORER_DEBUG
                         {
-                            auto &&_ = std::lock_guard<decltype(osc_sequence_mutex)>(osc_sequence_mutex);
+                            auto &&_ = std::lock_guard<decltype(writer_mutex)>(writer_mutex);
                             ofLogNotice("process finish") << i;
                         }
 #endif
@@ -268,13 +1009,14 @@ namespace ofx {
             } // setupSubProcesses
             
             void trashQueue() {
-                SequenceData trash;
-                while(!save_queue.empty()) save_queue.receive(trash);
+                std::uint64_t ticket;
+                while(save_queue.popWith([](const detail::queued_data &) {}, ticket)) --num_pending;
             }
         };
     };
 };
 
 using ofxOscRecorder = ofx::RecordOsc::Recorder;
+using ofxOscRecorderSaveResult = ofx::RecordOsc::SaveResult;
 
 #endif /* ofxOscRecorder_h */
@@ -0,0 +1,292 @@
+//
+//  ofxRecordOscAddressFilter.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscAddressFilter_h
+#define ofxRecordOscAddressFilter_h
+
+#include "ofLog.h"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+#include <algorithm>
+
+namespace ofx {
+    namespace RecordOsc {
+        namespace detail {
+            // a part between '/' of OSC 1.0 address pattern.
+            //   ?      : any single character
+            //   *      : any sequence of characters (zero or more)
+            //   [abc]  : one of characters. [a-z] range, [!a-z] negation
+            //   {x,yz} : one of strings
+            struct pattern_part {
+                enum class kind : std::uint8_t {
+                    literal,
+                    any_char,
+                    any_string,
+                    char_class,
+                    alternatives
+                };
+
+                struct token {
+                    kind type;
+                    std::string text;                      // literal or characters of class
+                    bool negate;                           // for char_class
+                    std::vector<std::string> alternatives; // for alternatives
+                };
+
+                std::vector<token> tokens;
+
+                bool compile(const std::string &source) {
+                    tokens.clear();
+                    std::size_t i = 0;
+                    while(i < source.length()) {
+                        auto c = source[i];
+                        if(c == '?') {
+                            tokens.push_back({kind::any_char, "", false, {}});
+                            ++i;
+                        } else if(c == '*') {
+                            // ** is same as *
+                            if(tokens.empty() || tokens.back().type != kind::any_string) {
+                                tokens.push_back({kind::any_string, "", false, {}});
+                            }
+                            ++i;
+                        } else if(c == '[') {
+                            auto close = source.find(']', i + 1);
+                            if(close == std::string::npos) return false;
+                            token t{kind::char_class, "", false, {}};
+                            auto j = i + 1;
+                            if(j < close && source[j] == '!') {
+                                t.negate = true;
+                                ++j;
+                            }
+                            for(; j < close; ++j) {
+                                if(j + 2 < close && source[j + 1] == '-') {
+                                    for(int ch = static_cast<unsigned char>(source[j]); ch <= static_cast<unsigned char>(source[j + 2]); ++ch) {
+                                        t.text.push_back(static_cast<char>(ch));
+                                    }
+                                    j += 2;
+                                } else {
+                                    t.text.push_back(source[j]);
+                                }
+                            }
+                            tokens.push_back(std::move(t));
+                            i = close + 1;
+                        } else if(c == '{') {
+                            auto close = source.find('}', i + 1);
+                            if(close == std::string::npos) return false;
+                            token t{kind::alternatives, "", false, {}};
+                            std::size_t begin = i + 1;
+                            while(true) {
+                                auto comma = source.find(',', begin);
+                                if(comma == std::string::npos || close < comma) comma = close;
+                                t.alternatives.push_back(source.substr(begin, comma - begin));
+                                if(comma == close) break;
+                                begin = comma + 1;
+                            }
+                            tokens.push_back(std::move(t));
+                            i = close + 1;
+                        } else if(c == ']' || c == '}') {
+                            return false;
+                        } else {
+                            if(tokens.empty() || tokens.back().type != kind::literal) {
+                                tokens.push_back({kind::literal, "", false, {}});
+                            }
+                            tokens.back().text.push_back(c);
+                            ++i;
+                        }
+                    }
+                    return true;
+                }
+
+                bool isLiteral() const
+                { return tokens.empty() || (tokens.size() == 1 && tokens[0].type == kind::literal); };
+
+                std::string literal() const
+                { return tokens.empty() ? std::string{} : tokens[0].text; };
+
+                bool match(const char *begin, const char *end) const
+                { return match(0, begin, end); };
+
+            private:
+                bool match(std::size_t index, const char *p, const char *end) const {
+                    if(index == tokens.size()) return p == end;
+                    const auto &t = tokens[index];
+                    switch(t.type) {
+                        case kind::literal:
+                            if(static_cast<std::size_t>(end - p) < t.text.length()) return false;
+                            if(t.text.compare(0, t.text.length(), p, t.text.length()) != 0) return false;
+                            return match(index + 1, p + t.text.length(), end);
+                        case kind::any_char:
+                            return p != end && match(index + 1, p + 1, end);
+                        case kind::any_string:
+                            for(auto q = p; ; ++q) {
+                                if(match(index + 1, q, end)) return true;
+                                if(q == end) return false;
+                            }
+                        case kind::char_class: {
+                            if(p == end) return false;
+                            bool found = t.text.find(*p) != std::string::npos;
+                            return found != t.negate && match(index + 1, p + 1, end);
+                        }
+                        case kind::alternatives:
+                            for(const auto &alt : t.alternatives) {
+                                if(static_cast<std::size_t>(end - p) < alt.length()) continue;
+                                if(alt.compare(0, alt.length(), p, alt.length()) != 0) continue;
+                                if(match(index + 1, p + alt.length(), end)) return true;
+                            }
+                            return false;
+                    }
+                    return false;
+                }
+            }; // struct pattern_part
+        }; // namespace detail
+
+        // set of OSC address patterns compiled into trie of parts.
+        // literal parts are followed by one hash lookup,
+        // only parts with wildcard are tested one by one.
+        struct AddressPatternSet {
+            AddressPatternSet()
+            : nodes(1) {}
+
+            void add(const std::string &pattern) {
+                std::size_t current = 0;
+                forEachPart(pattern, [&](const char *begin, const char *end) {
+                    std::string source(begin, end);
+                    detail::pattern_part part;
+                    if(!part.compile(source)) {
+                        ofLogWarning("ofxRecordOsc") << "malformed address pattern: " << pattern << ". it is treated as literal.";
+                        part.tokens.clear();
+                        part.tokens.push_back({detail::pattern_part::kind::literal, source, false, {}});
+                    }
+                    if(part.isLiteral()) {
+                        auto it = nodes[current].literal_children.find(source);
+                        if(it != nodes[current].literal_children.end()) {
+                            current = it->second;
+                        } else {
+                            auto next = nodes.size();
+                            nodes[current].literal_children.emplace(source, next);
+                            nodes.emplace_back();
+                            current = next;
+                        }
+                    } else {
+                        auto next = nodes.size();
+                        nodes[current].pattern_children.emplace_back(std::move(part), next);
+                        nodes.emplace_back();
+                        current = next;
+                    }
+                });
+                nodes[current].terminal = true;
+                ++num_patterns;
+            }
+
+            bool match(const std::string &address) const {
+                if(num_patterns == 0) return false;
+                std::vector<std::size_t> current{0}, next;
+                std::string key;
+                forEachPart(address, [&](const char *begin, const char *end) {
+                    next.clear();
+                    key.assign(begin, end);
+                    for(auto index : current) {
+                        const auto &n = nodes[index];
+                        auto it = n.literal_children.find(key);
+                        if(it != n.literal_children.end()) next.push_back(it->second);
+                        for(const auto &child : n.pattern_children) {
+                            if(child.first.match(begin, end)) next.push_back(child.second);
+                        }
+                    }
+                    std::swap(current, next);
+                });
+                for(auto index : current) if(nodes[index].terminal) return true;
+                return false;
+            }
+
+            bool empty() const
+            { return num_patterns == 0; };
+
+        private:
+            struct node {
+                std::unordered_map<std::string, std::size_t> literal_children;
+                std::vector<std::pair<detail::pattern_part, std::size_t>> pattern_children;
+                bool terminal{false};
+            };
+            std::vector<node> nodes;
+            std::size_t num_patterns{0};
+
+            template <typename callback_t>
+            static void forEachPart(const std::string &address, callback_t callback) {
+                const char *p = address.data();
+                const char *end = p + address.length();
+                if(p != end && *p == '/') ++p;
+                while(true) {
+                    auto slash = std::find(p, end, '/');
+                    callback(p, slash);
+                    if(slash == end) break;
+                    p = slash + 1;
+                }
+            }
+        }; // struct AddressPatternSet
+
+        // whitelist / blacklist of address patterns.
+        // compiled rules are replaced atomically, so rules can be changed while receiving.
+        struct AddressFilter {
+            // decisions per address. must be used only by one thread (e.g. per port)
+            struct Cache {
+                std::unordered_map<std::string, bool> decisions;
+                std::uint64_t generation{0};
+                std::size_t max_size{4096};
+            };
+
+            void setup(const std::set<std::string> &whitelists,
+                       const std::set<std::string> &blacklists)
+            {
+                auto &&compiled = std::make_shared<rules>();
+                for(const auto &pattern : whitelists) compiled->whitelists.add(pattern);
+                for(const auto &pattern : blacklists) compiled->blacklists.add(pattern);
+                std::atomic_store(&current, std::shared_ptr<const rules>(compiled));
+                ++generation;
+            }
+
+            bool isAllowed(const std::string &address) const {
+                auto &&compiled = std::atomic_load(&current);
+                if(!compiled) return true;
+                if(!compiled->whitelists.empty() && !compiled->whitelists.match(address)) return false;
+                if(!compiled->blacklists.empty() && compiled->blacklists.match(address)) return false;
+                return true;
+            }
+
+            // repeated address costs only one hash lookup
+            bool isAllowed(const std::string &address, Cache &cache) const {
+                auto current_generation = generation.load();
+                if(cache.generation != current_generation) {
+                    cache.decisions.clear();
+                    cache.generation = current_generation;
+                }
+                auto it = cache.decisions.find(address);
+                if(it != cache.decisions.end()) return it->second;
+                auto allowed = isAllowed(address);
+                if(cache.max_size <= cache.decisions.size()) cache.decisions.clear();
+                cache.decisions.emplace(address, allowed);
+                return allowed;
+            }
+
+        private:
+            struct rules {
+                AddressPatternSet whitelists;
+                AddressPatternSet blacklists;
+            };
+            std::shared_ptr<const rules> current;
+            std::atomic<std::uint64_t> generation{1};
+        }; // struct AddressFilter
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscAddressFilter = ofx::RecordOsc::AddressFilter;
+
+#endif /* ofxRecordOscAddressFilter_h */
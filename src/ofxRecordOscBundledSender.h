@@ -0,0 +1,288 @@
+//
+//  ofxRecordOscBundledSender.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscBundledSender_h
+#define ofxRecordOscBundledSender_h
+
+#include "ofxOscMessageEx.h"
+#include "ofxRecordOscPacket.h"
+
+#include "ofLog.h"
+
+#ifdef __linux__
+#   include <sys/types.h>
+#   include <sys/socket.h>
+#   include <netinet/in.h>
+#   include <netdb.h>
+#   include <unistd.h>
+#   include <cerrno>
+#else
+// sockets of oscpack bundled with ofxOsc
+#   include "UdpSocket.h"
+#   include <memory>
+#endif
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+namespace ofx {
+    namespace RecordOsc {
+        namespace detail {
+            namespace osc {
+                // "immediately" of OSC 1.0
+                constexpr std::uint64_t immediate_timetag = 1;
+            }; // namespace osc
+        }; // namespace detail
+
+        struct BundledSenderStats {
+            std::uint64_t num_messages{0};
+            std::uint64_t num_datagrams{0};
+            std::uint64_t num_syscalls{0};
+            std::uint64_t num_dropped_datagrams{0};
+        };
+
+        // sends messages to one host, grouped into OSC bundles per destination port.
+        // add messages due in the same tick, then flush. a bundle is split before it gets larger than
+        // max_datagram_size, a message larger than it is sent alone in its bundle.
+        // on linux, all datagrams of flush are sent by one sendmmsg on one socket,
+        // otherwise by socket of oscpack cached per port.
+        // not thread safe. use one sender per thread.
+        struct BundledSender {
+            // fits into ethernet MTU 1500 with IPv4 and UDP headers
+            static constexpr std::size_t default_max_datagram_size = 1472;
+
+            BundledSender() = default;
+            // copy has own socket to same host and same settings. queued messages and stats are not copied.
+            // it is only for copying owner (e.g. Player)
+            BundledSender(const BundledSender &x)
+            { *this = x; };
+            BundledSender &operator=(const BundledSender &x) {
+                if(this == &x) return *this;
+                close();
+                if(x.is_setup) setup(x.host);
+                max_datagram_size = x.max_datagram_size;
+                timetag = x.timetag;
+                return *this;
+            }
+            ~BundledSender()
+            { close(); };
+
+            // host is resolved here, not per message
+            bool setup(const std::string &host) {
+                close();
+                this->host = host;
+#ifdef __linux__
+                addrinfo hints{};
+                hints.ai_family = AF_INET; // same as oscpack
+                hints.ai_socktype = SOCK_DGRAM;
+                addrinfo *result = nullptr;
+                if(getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0 || result == nullptr) {
+                    ofLogError("ofxRecordOsc") << "can't resolve host " << host;
+                    return false;
+                }
+                address = reinterpret_cast<const sockaddr_in *>(result->ai_addr)->sin_addr;
+                freeaddrinfo(result);
+                fd = ::socket(AF_INET, SOCK_DGRAM, 0);
+                if(fd < 0) {
+                    ofLogError("ofxRecordOsc") << "can't open socket: " << std::strerror(errno);
+                    return false;
+                }
+                // ofxOscSender enables broadcast too
+                int enabled = 1;
+                setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &enabled, sizeof(enabled));
+#endif
+                is_setup = true;
+                return true;
+            }
+
+            void close() {
+                is_setup = false;
+                destinations.clear();
+                last_destination = 0;
+#ifdef __linux__
+                if(0 <= fd) ::close(fd);
+                fd = -1;
+#endif
+            }
+
+            bool isSetup() const
+            { return is_setup; };
+
+            const std::string &getHost() const
+            { return host; };
+
+            // mess is queued into bundle for port
+            void add(std::uint16_t port, const ofxOscMessageEx &mess) {
+                if(!is_setup) return;
+                encoded.clear();
+                detail::osc::write_message(encoded, mess);
+                addEncoded(port, encoded.data(), encoded.size());
+            }
+
+            // mess is queued into bundle for its waiting port
+            void add(const ofxOscMessageEx &mess)
+            { add(mess.getWaitingPort(), mess); };
+
+            // encoded OSC message (not bundle)
+            void addEncoded(std::uint16_t port, const std::uint8_t *data, std::size_t size) {
+                if(!is_setup) return;
+                auto &dest = destinationOf(port);
+                if(dest.num_datagrams == 0) {
+                    openBundle(dest);
+                } else {
+                    // bundle element is prefixed by its size. empty bundle takes a message of any size
+                    const auto &last = dest.datagrams[dest.num_datagrams - 1];
+                    if(last.size() != bundle_header_size && max_datagram_size < last.size() + 4 + size) openBundle(dest);
+                }
+                auto &datagram = dest.datagrams[dest.num_datagrams - 1];
+                detail::osc::write_be32(datagram, static_cast<std::uint32_t>(size));
+                datagram.insert(datagram.end(), data, data + size);
+                ++stats.num_messages;
+            }
+
+            // sends all queued bundles. returns number of sent datagrams
+            std::size_t flush() {
+                if(!is_setup) return 0;
+                std::size_t num_sent = 0;
+#ifdef __linux__
+                headers.clear();
+                vectors.clear();
+                for(auto &dest : destinations) {
+                    for(std::size_t i = 0; i < dest.num_datagrams; ++i) {
+                        iovec v;
+                        v.iov_base = dest.datagrams[i].data();
+                        v.iov_len = dest.datagrams[i].size();
+                        vectors.push_back(v);
+                        mmsghdr header{};
+                        header.msg_hdr.msg_name = &dest.endpoint;
+                        header.msg_hdr.msg_namelen = sizeof(dest.endpoint);
+                        headers.push_back(header);
+                    }
+                }
+                // vectors are not reallocated from here
+                for(std::size_t i = 0; i < headers.size(); ++i) {
+                    headers[i].msg_hdr.msg_iov = &vectors[i];
+                    headers[i].msg_hdr.msg_iovlen = 1;
+                }
+                std::size_t p = 0;
+                while(p < headers.size()) {
+                    auto num = (std::min)(headers.size() - p, static_cast<std::size_t>(max_datagrams_per_syscall));
+                    auto result = ::sendmmsg(fd, headers.data() + p, static_cast<unsigned int>(num), 0);
+                    ++stats.num_syscalls;
+                    if(result < 0) {
+                        if(errno == EINTR) continue;
+                        // the first datagram is failed, skip it and try rest
+                        ofLogWarning("ofxRecordOsc") << "can't send bundle to " << host << ": " << std::strerror(errno);
+                        ++stats.num_dropped_datagrams;
+                        ++p;
+                        continue;
+                    }
+                    p += static_cast<std::size_t>(result);
+                    num_sent += static_cast<std::size_t>(result);
+                }
+#else
+                for(auto &dest : destinations) {
+                    for(std::size_t i = 0; i < dest.num_datagrams; ++i) {
+                        const auto &datagram = dest.datagrams[i];
+                        ++stats.num_syscalls;
+                        try {
+                            if(!dest.socket) dest.socket = std::make_shared<::osc::UdpTransmitSocket>(::osc::IpEndpointName(host.c_str(), dest.port));
+                            dest.socket->Send(reinterpret_cast<const char *>(datagram.data()), datagram.size());
+                            ++num_sent;
+                        } catch(const std::exception &e) {
+                            ofLogWarning("ofxRecordOsc") << "can't send bundle to " << host << ":" << dest.port << ": " << e.what();
+                            dest.socket.reset();
+                            ++stats.num_dropped_datagrams;
+                        }
+                    }
+                }
+#endif
+                for(auto &dest : destinations) dest.num_datagrams = 0;
+                stats.num_datagrams += num_sent;
+                return num_sent;
+            }
+
+            const BundledSenderStats &getStats() const
+            { return stats; };
+
+            void resetStats()
+            { stats = BundledSenderStats{}; };
+
+            std::size_t max_datagram_size{default_max_datagram_size};
+            // timetag of bundles. immediately by default
+            std::uint64_t timetag{detail::osc::immediate_timetag};
+
+        private:
+            static constexpr std::size_t bundle_header_size = 16;
+            // UIO_MAXIOV
+            static constexpr std::size_t max_datagrams_per_syscall = 1024;
+
+            struct destination {
+                std::uint16_t port{0};
+                // buffers are reused over flushes, first num_datagrams are queued
+                std::vector<std::vector<std::uint8_t>> datagrams;
+                std::size_t num_datagrams{0};
+#ifdef __linux__
+                sockaddr_in endpoint{};
+#else
+                std::shared_ptr<::osc::UdpTransmitSocket> socket;
+#endif
+            };
+
+            std::string host;
+            bool is_setup{false};
+            // a few ports per host, so linear search from last used one
+            std::vector<destination> destinations;
+            std::size_t last_destination{0};
+            std::vector<std::uint8_t> encoded;
+            BundledSenderStats stats;
+#ifdef __linux__
+            int fd{-1};
+            in_addr address{};
+            std::vector<mmsghdr> headers;
+            std::vector<iovec> vectors;
+#endif
+
+            destination &destinationOf(std::uint16_t port) {
+                if(last_destination < destinations.size() && destinations[last_destination].port == port) {
+                    return destinations[last_destination];
+                }
+                for(std::size_t i = 0; i < destinations.size(); ++i) {
+                    if(destinations[i].port == port) {
+                        last_destination = i;
+                        return destinations[i];
+                    }
+                }
+                destinations.emplace_back();
+                auto &dest = destinations.back();
+                dest.port = port;
+#ifdef __linux__
+                dest.endpoint.sin_family = AF_INET;
+                dest.endpoint.sin_port = htons(port);
+                dest.endpoint.sin_addr = address;
+#endif
+                last_destination = destinations.size() - 1;
+                return dest;
+            }
+
+            void openBundle(destination &dest) {
+                if(dest.datagrams.size() == dest.num_datagrams) dest.datagrams.emplace_back();
+                auto &datagram = dest.datagrams[dest.num_datagrams++];
+                datagram.clear();
+                datagram.insert(datagram.end(), detail::osc::bundle_tag, detail::osc::bundle_tag + sizeof(detail::osc::bundle_tag));
+                detail::osc::write_be64(datagram, timetag);
+            }
+        }; // struct BundledSender
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscBundledSender = ofx::RecordOsc::BundledSender;
+using ofxRecordOscBundledSenderStats = ofx::RecordOsc::BundledSenderStats;
+
+#endif /* ofxRecordOscBundledSender_h */
@@ -8,6 +8,8 @@
 #ifndef ofxRecordOscMetadata_h
 #define ofxRecordOscMetadata_h
 
+#include "ofxOscMessageExJsonConversion.h"
+
 #include "ofUtils.h"
 #include "ofJson.h"
 
@@ -18,55 +20,80 @@
 #include <string>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <ctime>
 #include <set>
+#include <cmath>
+#include <limits>
 #include <sys/stat.h>
 
 namespace ofx {
     namespace RecordOsc {
         struct SequenceData {
-            double offset;
+            // offset from start of recording [sec]
+            double offset{0.0};
             ofxOscMessageEx mess;
+            // order of arrival in recording session
+            std::uint64_t sequence{0};
+            // offset from start of recording [nanosec]. full precision of offset
+            std::int64_t offset_ns{0};
+            // OSC timetag of the bundle contained this message. 0 if unknown
+            std::uint64_t timetag{0};
+            // id in address table of Player (or dictionary of native file)
+            std::uint32_t address_id{unknown_address_id};
+            
+            static constexpr std::uint32_t unknown_address_id = 0xFFFFFFFF;
+            
+            void setOffsetNanos(std::int64_t nanos) {
+                offset_ns = nanos;
+                offset = nanos / 1000000000.0;
+            }
+            
+            void setOffset(double sec) {
+                offset = sec;
+                offset_ns = std::llround(sec * 1000000000.0);
+            }
             
 #pragma mark compare for sorting
             bool operator==(double t) const
             { return offset == t; };
             bool operator==(const SequenceData &m) const
-            { return offset == m.offset; };
+            { return offset_ns == m.offset_ns; };
             friend bool operator==(double t, const SequenceData &m)
             { return t == m.offset; };
             
             bool operator!=(double t) const
             { return offset != t; };
             bool operator!=(const SequenceData &m) const
-            { return offset != m.offset; };
+            { return offset_ns != m.offset_ns; };
             friend bool operator!=(double t, const SequenceData &m)
             { return t != m.offset; };
 
             bool operator<(double t) const
             { return offset < t; };
             bool operator<(const SequenceData &m) const
-            { return offset < m.offset; };
+            { return offset_ns < m.offset_ns; };
             friend bool operator<(double t, const SequenceData &m)
             { return t < m.offset; };
 
             bool operator<=(double t) const
             { return offset <= t; };
             bool operator<=(const SequenceData &m) const
-            { return offset <= m.offset; };
+            { return offset_ns <= m.offset_ns; };
             friend bool operator<=(double t, const SequenceData &m)
             { return t <= m.offset; };
 
             bool operator>(double t) const
             { return offset > t; };
             bool operator>(const SequenceData &m) const
-            { return offset > m.offset; };
+            { return offset_ns > m.offset_ns; };
             friend bool operator>(double t, const SequenceData &m)
             { return t > m.offset; };
 
             bool operator>=(double t) const
             { return offset >= t; };
             bool operator>=(const SequenceData &m) const
-            { return offset >= m.offset; };
+            { return offset_ns >= m.offset_ns; };
             friend bool operator>=(double t, const SequenceData &m)
             { return t >= m.offset; };
             
@@ -74,8 +101,25 @@ namespace ofx {
             inline void from_json(const ofJson &json,
                                   SequenceData &m)
             {
-                m.offset = json[0].get<double>();
+                // [offset, message] or [offset, message, offset_ns, timetag]
+                if(2 < json.size()) {
+                    m.setOffsetNanos(json[2].get<std::int64_t>());
+                    m.timetag = json[3].get<std::uint64_t>();
+                } else {
+                    m.setOffset(json[0].get<double>());
+                    m.timetag = 0;
+                }
                 m.mess = json[1];
+                m.address_id = unknown_address_id;
+            }
+            
+            friend
+            inline void to_json(ofJson &json,
+                                const SequenceData &m)
+            {
+                ofJson mess_json;
+                to_json(mess_json, m.mess);
+                json = ofJson::array({m.offset, std::move(mess_json), m.offset_ns, m.timetag});
             }
         }; // struct SequenceData
         
@@ -163,17 +207,28 @@ namespace ofx {
             
 #pragma mark -
             
+            // [sec]
             double duration;
+            std::int64_t duration_ns{0};
             
             void start() {
                 started_time_str = ofGetTimestampString("%Y/%m/%d %H:%M:%S.%i");
                 started_timestamp = ofGetUnixTime();
             }
             
-            void finish(double duration_ms) {
+            // [sec]
+            void finish(double duration_sec) {
+                finished_time_str = ofGetTimestampString("%Y/%m/%d %H:%M:%S.%i");
+                finished_timestamp = ofGetUnixTime();
+                duration = duration_sec;
+                duration_ns = std::llround(duration_sec * 1000000000.0);
+            }
+            
+            void finishNanos(std::int64_t duration_nanos) {
                 finished_time_str = ofGetTimestampString("%Y/%m/%d %H:%M:%S.%i");
                 finished_timestamp = ofGetUnixTime();
-                duration = duration_ms;
+                duration = duration_nanos / 1000000000.0;
+                duration_ns = duration_nanos;
             }
             
             friend
@@ -188,6 +243,9 @@ namespace ofx {
                 md.finished_time_str  = j["finished_time_str"].get<std::string>();
                 md.finished_timestamp = j["finished_timestamp"];
                 md.duration           = j["duration"];
+                md.duration_ns        = j.find("duration_ns") != j.end()
+                                      ? j["duration_ns"].get<std::int64_t>()
+                                      : std::llround(md.duration * 1000000000.0);
                 
                 md.whitelists         = j["whitelists"].get<decltype(md.whitelists)>();
                 md.blacklists         = j["blacklists"].get<decltype(md.blacklists)>();
@@ -206,6 +264,7 @@ namespace ofx {
                 j["finished_time_str"]  = md.finished_time_str;
                 j["finished_timestamp"] = md.finished_timestamp;
                 j["duration"]           = md.duration;
+                j["duration_ns"]        = md.duration_ns;
                 
                 j["whitelists"]         = md.whitelists;
                 j["blacklists"]         = md.blacklists;
@@ -218,10 +277,16 @@ namespace ofx {
             Bson,
             CBOR,
             MessagePack,
-            UBJson
+            UBJson,
+            Native
         };
         
         namespace detail {
+            // defined in ofxRecordOscNativeFormat.h
+            inline ofJson load_native(const std::string &filepath);
+            inline bool save_native(const std::string &filepath,
+                                    const ofJson &json);
+            
             std::string to_ext(FileFormat format) {
                 switch(format) {
                     case FileFormat::Bson: return "bson";
@@ -229,12 +294,27 @@ namespace ofx {
                     case FileFormat::MessagePack: return "msgpack";
                     case FileFormat::UBJson: return "ubjson";
                     case FileFormat::Json: return "json";
+                    case FileFormat::Native: return "oscrec";
                     default:
                         ofLogWarning("ofxRecordOsc") << "unknown file format: " << (int)format << ". file will be write by JSON format.";
                         return "json";
                 }
             }
             
+            // unknown format is written as JSON
+            inline bool is_json_format(FileFormat format) {
+                switch(format) {
+                    case FileFormat::Bson:
+                    case FileFormat::CBOR:
+                    case FileFormat::MessagePack:
+                    case FileFormat::UBJson:
+                    case FileFormat::Native:
+                        return false;
+                    default:
+                        return true;
+                }
+            }
+            
             bool save_binary(const std::string &filepath,
                              const std::vector<std::uint8_t> &&data)
             {
@@ -244,15 +324,22 @@ namespace ofx {
                     return false;
                 }
                 auto wrote = std::fwrite(data.data(), sizeof(std::uint8_t), data.size(), fp);
-                if(wrote == data.size()) return true;
+                if(std::fclose(fp) == 0 && wrote == data.size()) return true;
                 ofLogWarning("ofxRecordOsc") << "written size is incorrect. written: " << wrote << ", data-size: " << data.size();
                 return false;
             }
             
+            // blobs are converted for JSON in place
+            bool save(const std::string &filepath,
+                      ofJson &&json,
+                      FileFormat format);
+            
             bool save(const std::string &filepath,
                       const ofJson &json,
                       FileFormat format)
             {
+                // copy is made only if blobs have to be converted for JSON
+                if(is_json_format(format) && has_binary_blobs(json)) return save(filepath, ofJson(json), format);
                 switch(format) {
                     case FileFormat::Bson:
                         return save_binary(filepath, ofJson::to_bson(json));
@@ -261,15 +348,26 @@ namespace ofx {
                     case FileFormat::MessagePack:
                         return save_binary(filepath, ofJson::to_msgpack(json));
                     case FileFormat::UBJson:
-                        return save_binary(filepath, ofJson::to_ubjson(json));
+                        // typed arrays keep blobs 1 byte per byte
+                        return save_binary(filepath, ofJson::to_ubjson(json, true, true));
                     case FileFormat::Json:
                         return ofSaveJson(filepath, json);
+                    case FileFormat::Native:
+                        return save_native(ofToDataPath(filepath, true), json);
                     default:
                         ofLogWarning("ofxRecordOsc") << "unknown file format: " << (int)format << ". file will be write by JSON format.";
                         return ofSaveJson(filepath, json);
                 }
             }
             
+            bool save(const std::string &filepath,
+                      ofJson &&json,
+                      FileFormat format)
+            {
+                if(is_json_format(format)) encode_blobs_for_json(json);
+                return save(filepath, static_cast<const ofJson &>(json), format);
+            }
+            
             bool load_binary(const std::string &filepath,
                              std::vector<std::uint8_t> &data)
             {
@@ -282,6 +380,7 @@ namespace ofx {
                 struct stat stat_buf;
                 if(stat(filepath.c_str(), &stat_buf) != 0) {
                     ofLogError("ofxRecordOsc") << "can't open file: " << filepath << " on load.";
+                    std::fclose(fp);
                     return false;
                 }
                 
@@ -291,9 +390,10 @@ namespace ofx {
                 std::size_t read = 0;
                 std::size_t read_fragment = 0;
                 do {
-                    read_fragment = std::fread(data.data() + read_fragment, sizeof(std::uint8_t), data.size(), fp);
+                    read_fragment = std::fread(data.data() + read, sizeof(std::uint8_t), data.size() - read, fp);
                     read += read_fragment;
-                } while(0 < read_fragment);
+                } while(0 < read_fragment && read < data.size());
+                std::fclose(fp);
                 if(read == data.size()) return true;
                 ofLogWarning("ofxRecordOsc") << "read size is incorrect. read: " << read << ", required data-size: " << data.size();
                 return false;
@@ -325,15 +425,64 @@ namespace ofx {
                     }
                     case FileFormat::Json:
                         return ofLoadJson(filepath);
+                    case FileFormat::Native:
+                        return load_native(ofToDataPath(filepath, true));
                     default:
                         ofLogWarning("ofxRecordOsc") << "unknown file format: " << (int)format << ". file will be write by JSON format.";
                         return ofLoadJson(filepath);
                 }
             }
+
+            // numeric argument as double, NaN if argument is not numeric
+            inline double arg_as_double(const ofxOscMessageEx &mess, std::size_t i) {
+                switch(mess.getArgType(i)) {
+                    case OFXOSC_TYPE_INT32:  return mess.getArgAsInt32(i);
+                    case OFXOSC_TYPE_INT64:  return static_cast<double>(mess.getArgAsInt64(i));
+                    case OFXOSC_TYPE_FLOAT:  return mess.getArgAsFloat(i);
+                    case OFXOSC_TYPE_DOUBLE: return mess.getArgAsDouble(i);
+                    case OFXOSC_TYPE_CHAR:   return mess.getArgAsChar(i);
+                    case OFXOSC_TYPE_TRUE:   return 1.0;
+                    case OFXOSC_TYPE_FALSE:  return 0.0;
+                    default:                 return std::numeric_limits<double>::quiet_NaN();
+                }
+            }
+
+            // unix time [nanosec] as local time of Metadata::started_time_str ("%Y/%m/%d %H:%M:%S.%i")
+            inline std::string timestamp_string(std::int64_t unix_ns) {
+                std::time_t seconds = static_cast<std::time_t>(unix_ns / 1000000000);
+                const std::tm *local = std::localtime(&seconds);
+                if(local == nullptr) return "";
+                char buf[32];
+                auto length = std::strftime(buf, sizeof(buf), "%Y/%m/%d %H:%M:%S", local);
+                char millis[8];
+                std::snprintf(millis, sizeof(millis), ".%03d", static_cast<int>(unix_ns / 1000000 % 1000));
+                return std::string(buf, length) + millis;
+            }
+
+            // inverse of timestamp_string. returns false if str is not formatted so
+            inline bool parse_timestamp_string(const std::string &str, std::int64_t &unix_ns) {
+                std::tm local{};
+                int millis = 0;
+                if(std::sscanf(str.c_str(), "%d/%d/%d %d:%d:%d.%d",
+                               &local.tm_year, &local.tm_mon, &local.tm_mday,
+                               &local.tm_hour, &local.tm_min, &local.tm_sec, &millis) != 7)
+                {
+                    return false;
+                }
+                local.tm_year -= 1900;
+                local.tm_mon -= 1;
+                local.tm_isdst = -1;
+                auto seconds = std::mktime(&local);
+                if(seconds == static_cast<std::time_t>(-1)) return false;
+                unix_ns = static_cast<std::int64_t>(seconds) * 1000000000 + static_cast<std::int64_t>(millis) * 1000000;
+                return true;
+            }
         }; // namespace detail
     }; // namespace RecordOsc
 }; // namespace ofx
 
 using ofxRecordOscFileFormat = ofx::RecordOsc::FileFormat;
 
+#include "ofxRecordOscNativeFormat.h"
+
 #endif /* ofxRecordOscMetadata_h */
@@ -0,0 +1,491 @@
+//
+//  ofxRecordOscEditor.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscEditor_h
+#define ofxRecordOscEditor_h
+
+#include "ofxRecordOscData.h"
+#include "ofxRecordOscAddressFilter.h"
+#include "ofxRecordOscMetrics.h"
+#include "ofxRecordOscNativeFormat.h"
+#include "ofxRecordOscSequenceReader.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <chrono>
+#include <limits>
+#include <algorithm>
+#include <iterator>
+
+namespace ofx {
+    namespace RecordOsc {
+        namespace detail {
+            constexpr std::int64_t earliest_offset_ns = (std::numeric_limits<std::int64_t>::min)();
+            constexpr std::int64_t latest_offset_ns = (std::numeric_limits<std::int64_t>::max)();
+
+            inline std::int64_t saturated_sub(std::int64_t x, std::int64_t y) {
+                if(0 < y && x < earliest_offset_ns + y) return earliest_offset_ns;
+                if(y < 0 && latest_offset_ns + y < x) return latest_offset_ns;
+                return x - y;
+            }
+
+            // records and packets of Native file in order of offset.
+            // a chunk is decoded only when it can have the next record, so only a few chunks are kept in memory
+            // (all chunks overlapping in offsets, e.g. a file recorded with custom time calculator, are kept at once).
+            // packets of PKTS chunks (Recorder::listenRaw, PcapIngest::setRawPackets) are passed as they are.
+            struct edit_cursor {
+                bool open(const std::string &path) {
+                    if(!reader.open(path)) return false;
+                    reader.mappedFile().adviseSequential();
+                    return true;
+                }
+
+                // [from_ns, to_ns] in offsets of file
+                void start(std::int64_t from_ns,
+                           std::int64_t to_ns,
+                           const AddressFilter &filter)
+                {
+                    this->from_ns = from_ns;
+                    this->to_ns = to_ns;
+                    this->filter = &filter;
+                    const auto num_chunks = reader.numChunks();
+                    min_offsets_after.assign(num_chunks, latest_offset_ns);
+                    max_offsets.assign(num_chunks, earliest_offset_ns);
+                    for(std::size_t i = 0; i < num_chunks; ++i) {
+                        std::int64_t min_ns, max_ns;
+                        if(!reader.chunkOffsetRange(i, min_ns, max_ns)) continue;
+                        min_offsets_after[i] = min_ns;
+                        max_offsets[i] = max_ns;
+                    }
+                    for(std::size_t i = num_chunks; 1 < i; --i) {
+                        min_offsets_after[i - 2] = (std::min)(min_offsets_after[i - 2], min_offsets_after[i - 1]);
+                    }
+                    next_chunk = 0;
+                    pending.clear();
+                    head = 0;
+                    pending_packets.clear();
+                    packet_head = 0;
+                }
+
+                // false at the end. otherwise next is a record or a packet (see isPacketNext)
+                bool next() {
+                    while(next_chunk < min_offsets_after.size()) {
+                        // no record in rest of chunks precedes next one
+                        if(hasPending() && nextOffsetNanos() <= min_offsets_after[next_chunk]) break;
+                        if(to_ns < min_offsets_after[next_chunk]) {
+                            next_chunk = min_offsets_after.size();
+                            break;
+                        }
+                        decodeChunk(next_chunk++);
+                    }
+                    return hasPending();
+                }
+
+                // only after next() returned true. record precedes packet of same offset
+                std::int64_t nextOffsetNanos() const
+                { return isPacketNext() ? pending_packets[packet_head].offset_ns : pending[head].offset_ns; };
+
+                bool isPacketNext() const {
+                    if(pending_packets.size() <= packet_head) return false;
+                    return pending.size() <= head || pending_packets[packet_head].offset_ns < pending[head].offset_ns;
+                }
+
+                SequenceData &nextRecord()
+                { return pending[head]; };
+
+                RawPacket &nextPacket()
+                { return pending_packets[packet_head]; };
+
+                void pop() {
+                    if(isPacketNext()) ++packet_head;
+                    else ++head;
+                }
+
+                const NativeMappedReader &getReader() const
+                { return reader; };
+
+                std::uint64_t numFiltered() const
+                { return num_filtered; };
+
+            private:
+                NativeMappedReader reader;
+                std::int64_t from_ns{earliest_offset_ns};
+                std::int64_t to_ns{latest_offset_ns};
+                const AddressFilter *filter{nullptr};
+                AddressFilter::Cache filter_cache;
+                std::vector<std::int8_t> decisions; // per address id. -1 is unknown
+                std::string address;
+                std::vector<std::int64_t> min_offsets_after; // min of offsets in chunks[i, end)
+                std::vector<std::int64_t> max_offsets;
+                std::size_t next_chunk{0};
+                std::vector<SequenceData> pending; // sorted by offset
+                std::size_t head{0};
+                std::vector<RawPacket> pending_packets; // sorted by offset
+                std::size_t packet_head{0};
+                std::vector<SequenceData> decoded;
+                std::vector<RawPacket> packets;
+                std::uint64_t num_filtered{0};
+
+                bool hasPending() const
+                { return head < pending.size() || packet_head < pending_packets.size(); };
+
+                bool isAllowed(const SequenceData &data) {
+                    if(data.address_id == SequenceData::unknown_address_id) {
+                        return filter->isAllowed(data.mess.getAddress(), filter_cache);
+                    }
+                    if(decisions.size() <= data.address_id) decisions.resize(data.address_id + 1, -1);
+                    auto &decision = decisions[data.address_id];
+                    if(decision < 0) decision = filter->isAllowed(data.mess.getAddress(), filter_cache) ? 1 : 0;
+                    return decision == 1;
+                }
+
+                // same as Recorder::listenRaw. packet is kept if any message is allowed, broken packet is kept as is
+                bool isAllowed(const RawPacket &packet) {
+                    bool has_message = false, allowed = false;
+                    std::uint64_t num_messages = 0;
+                    detail::osc::for_each_message(packet.bytes.data(), packet.bytes.size(), [&](const detail::osc::message_view &m) {
+                        has_message = true;
+                        ++num_messages;
+                        if(allowed) return;
+                        address.assign(m.address, m.address_length);
+                        allowed = filter->isAllowed(address, filter_cache);
+                    });
+                    if(allowed || !has_message) return true;
+                    num_filtered += num_messages;
+                    return false;
+                }
+
+                // consumed entries are dropped before decoded ones in range are merged
+                template <typename entry_t, typename accept_t>
+                void merge(std::vector<entry_t> &pending,
+                           std::size_t &head,
+                           std::vector<entry_t> &decoded,
+                           std::size_t num_decoded,
+                           accept_t accept)
+                {
+                    pending.erase(pending.begin(), pending.begin() + head);
+                    head = 0;
+                    const auto middle = pending.size();
+                    for(std::size_t k = 0; k < num_decoded; ++k) {
+                        auto &entry = decoded[k];
+                        if(entry.offset_ns < from_ns || to_ns < entry.offset_ns) continue;
+                        if(!accept(entry)) continue;
+                        pending.push_back(std::move(entry));
+                    }
+                    auto earlier = [](const entry_t &x, const entry_t &y) { return x.offset_ns < y.offset_ns; };
+                    if(!std::is_sorted(pending.begin() + middle, pending.end(), earlier)) {
+                        std::stable_sort(pending.begin() + middle, pending.end(), earlier);
+                    }
+                    std::inplace_merge(pending.begin(), pending.begin() + middle, pending.end(), earlier);
+                }
+
+                void decodeChunk(std::size_t i) {
+                    if(max_offsets[i] < from_ns) return;
+                    if(reader.isPacketChunk(i)) {
+                        // messages of packets are not decoded as records, packets are written as they are
+                        packets.clear();
+                        reader.decodePackets(i, packets);
+                        merge(pending_packets, packet_head, packets, packets.size(), [this](const RawPacket &packet) {
+                            return isAllowed(packet);
+                        });
+                        return;
+                    }
+                    decoded.resize(reader.chunkAt(i).num_records);
+                    auto num_decoded = reader.decodeChunk(i, decoded.data(), packets);
+                    merge(pending, head, decoded, num_decoded, [this](const SequenceData &data) {
+                        if(isAllowed(data)) return true;
+                        ++num_filtered;
+                        return false;
+                    });
+                }
+            }; // struct edit_cursor
+
+            // document formats are streamed into Native spool, so all inputs are merged by same cursor
+            inline bool write_native_spool(const std::string &path,
+                                           FileFormat format,
+                                           const std::string &spool_path)
+            {
+                NativeWriter writer;
+                if(!writer.open(spool_path, Metadata{})) {
+                    ofLogError("ofxRecordOsc") << "can't open " << spool_path;
+                    return false;
+                }
+                SequenceReader reader;
+                auto succeeded = reader.read(path, format, [&writer](SequenceData &data) {
+                    writer.append(data);
+                });
+                return writer.close(reader.metadata()) && succeeded;
+            }
+        }; // namespace detail
+
+        // result of RecordingEditor::merge / concatenate
+        struct EditResult {
+            bool succeeded{false};
+            std::string path;
+            FileFormat format{FileFormat::Native};
+            std::uint64_t num_records{0};   // written records
+            std::uint64_t num_filtered{0};  // records in range rejected by address filter (messages of rejected packets)
+            double duration_sec{0.0};
+            double edit_duration_ms{0.0};
+        }; // struct EditResult
+
+        // merges, trims and concatenates recordings without loading them into Player.
+        // inputs are read chunk by chunk and merged by offset (k-way merge), records are written by NativeWriter,
+        // so memory usage is bounded by a few chunks per input, not by length of recordings.
+        // packets recorded by Recorder::listenRaw are written as packets, so output of Native format can be
+        // played by Player::playPackets. address filter keeps a packet if any message of it is allowed.
+        //
+        // offset of record in output is (offset in input + shift of input - from of range).
+        // Metadata of output:
+        //   started / finished time: start of first input moved to beginning of output, plus duration
+        //   duration: end of latest input (max of duration and last offset) in range
+        //   listening_ports: union of inputs
+        //   whitelists: address filter of editor if set, otherwise union of inputs if all of them have whitelists
+        //   blacklists: common ones of inputs and address filter of editor
+        struct RecordingEditor {
+            // shift_ns is added to offsets of input. it can be negative
+            void addInput(const std::string &path,
+                          FileFormat format = FileFormat::Native,
+                          std::int64_t shift_ns = 0)
+            { inputs.push_back({path, format, shift_ns}); };
+
+            void clearInputs()
+            { inputs.clear(); };
+
+            std::size_t numInputs() const
+            { return inputs.size(); };
+
+            // records in [from_ns, to_ns] of output are written and output starts at from_ns.
+            // range is applied after shift (and after placing of concatenate)
+            void setRangeNanos(std::int64_t from_ns, std::int64_t to_ns) {
+                range_from_ns = from_ns;
+                range_to_ns = to_ns;
+                has_range = true;
+            }
+
+            // [sec]
+            void setRange(double from, double to)
+            { setRangeNanos(std::llround(from * 1000000000.0), std::llround(to * 1000000000.0)); };
+
+            void clearRange()
+            { has_range = false; };
+
+            // address patterns, see AddressFilter
+            void setAddressFilter(const std::set<std::string> &whitelists,
+                                  const std::set<std::string> &blacklists = {})
+            {
+                this->whitelists = whitelists;
+                this->blacklists = blacklists;
+                filter.setup(whitelists, blacklists);
+            }
+
+            // compression of Native output. see NativeWriter::setCompression
+            void setCompression(Compression compression)
+            { this->compression = compression; };
+
+            // records of all inputs are interleaved by shifted offset.
+            // records of same offset are written in order of inputs.
+            EditResult merge(const std::string &output_path,
+                             FileFormat format = FileFormat::Native)
+            { return edit(output_path, format, false, 0); };
+
+            // inputs are placed one after another in order of addInput.
+            // each input starts at end of previous one (its duration) + gap_ns + its own shift
+            EditResult concatenate(const std::string &output_path,
+                                   FileFormat format = FileFormat::Native,
+                                   std::int64_t gap_ns = 0)
+            { return edit(output_path, format, true, gap_ns); };
+
+        private:
+            struct input {
+                std::string path;
+                FileFormat format;
+                std::int64_t shift_ns;
+            };
+
+            std::vector<input> inputs;
+            bool has_range{false};
+            std::int64_t range_from_ns{0};
+            std::int64_t range_to_ns{0};
+            std::set<std::string> whitelists;
+            std::set<std::string> blacklists;
+            AddressFilter filter;
+            Compression compression{Compression::None};
+
+            EditResult edit(const std::string &output_path,
+                            FileFormat format,
+                            bool concatenating,
+                            std::int64_t gap_ns)
+            {
+                auto started = std::chrono::steady_clock::now();
+                EditResult result;
+                result.format = format;
+                result.path = ofToDataPath(output_path, true);
+                if(inputs.empty()) {
+                    ofLogError("ofxRecordOsc") << "no input to edit.";
+                    return result;
+                }
+
+                std::vector<std::string> spool_paths;
+                auto remove_spools = [&spool_paths] {
+                    for(const auto &path : spool_paths) std::remove(path.c_str());
+                };
+                std::vector<std::unique_ptr<detail::edit_cursor>> cursors;
+                for(std::size_t i = 0; i < inputs.size(); ++i) {
+                    auto path = ofToDataPath(inputs[i].path, true);
+                    if(inputs[i].format != FileFormat::Native) {
+                        auto spool_path = result.path + "." + ofToString(i) + ".part.oscrec";
+                        spool_paths.push_back(spool_path);
+                        if(!detail::write_native_spool(path, inputs[i].format, spool_path)) {
+                            ofLogError("ofxRecordOsc") << "can't read " << path;
+                            remove_spools();
+                            return result;
+                        }
+                        path = spool_path;
+                    }
+                    std::unique_ptr<detail::edit_cursor> cursor(new detail::edit_cursor);
+                    if(!cursor->open(path)) {
+                        remove_spools();
+                        return result;
+                    }
+                    cursors.push_back(std::move(cursor));
+                }
+
+                // placing of inputs on output
+                std::vector<std::int64_t> shifts(inputs.size());
+                std::int64_t end_ns = detail::earliest_offset_ns;
+                std::int64_t position_ns = 0;
+                for(std::size_t i = 0; i < inputs.size(); ++i) {
+                    const auto &reader = cursors[i]->getReader();
+                    auto length_ns = (std::max)(reader.metadata().duration_ns, reader.lastOffsetNanos());
+                    shifts[i] = inputs[i].shift_ns + (concatenating ? position_ns : 0);
+                    position_ns = shifts[i] + length_ns + gap_ns;
+                    end_ns = (std::max)(end_ns, shifts[i] + length_ns);
+                }
+                auto from_ns = has_range ? range_from_ns : detail::earliest_offset_ns;
+                auto to_ns = has_range ? range_to_ns : detail::latest_offset_ns;
+                auto origin_ns = has_range ? range_from_ns : 0;
+                if(has_range) end_ns = (std::min)(end_ns, range_to_ns);
+                for(std::size_t i = 0; i < cursors.size(); ++i) {
+                    cursors[i]->start(detail::saturated_sub(from_ns, shifts[i]),
+                                      detail::saturated_sub(to_ns, shifts[i]),
+                                      filter);
+                }
+
+                auto metadata = mergedMetadata(cursors, shifts[0], origin_ns, (std::max<std::int64_t>)(end_ns - origin_ns, 0));
+                const bool is_native = format == FileFormat::Native;
+                auto writing_path = is_native ? result.path : result.path + ".part.oscrec";
+                NativeWriter writer;
+                writer.setCompression(is_native ? compression : Compression::None);
+                if(!writer.open(writing_path, metadata)) {
+                    ofLogError("ofxRecordOsc") << "can't open " << writing_path;
+                    cursors.clear();
+                    remove_spools();
+                    return result;
+                }
+
+                // k-way merge. heap of input indices, earliest record on top
+                std::vector<std::size_t> heap;
+                auto later = [&](std::size_t x, std::size_t y) {
+                    auto x_ns = cursors[x]->nextOffsetNanos() + shifts[x];
+                    auto y_ns = cursors[y]->nextOffsetNanos() + shifts[y];
+                    return x_ns != y_ns ? y_ns < x_ns : y < x;
+                };
+                for(std::size_t i = 0; i < cursors.size(); ++i) {
+                    if(cursors[i]->next()) heap.push_back(i);
+                }
+                std::make_heap(heap.begin(), heap.end(), later);
+                while(!heap.empty()) {
+                    std::pop_heap(heap.begin(), heap.end(), later);
+                    auto i = heap.back();
+                    auto &cursor = *cursors[i];
+                    if(cursor.isPacketNext()) {
+                        auto &packet = cursor.nextPacket();
+                        packet.offset_ns = packet.offset_ns + shifts[i] - origin_ns;
+                        writer.append(packet);
+                    } else {
+                        auto &data = cursor.nextRecord();
+                        data.setOffsetNanos(data.offset_ns + shifts[i] - origin_ns);
+                        writer.append(data);
+                    }
+                    cursor.pop();
+                    if(cursor.next()) std::push_heap(heap.begin(), heap.end(), later);
+                    else heap.pop_back();
+                }
+
+                for(const auto &cursor : cursors) result.num_filtered += cursor->numFiltered();
+                cursors.clear();
+                remove_spools();
+                result.num_records = writer.numRecords();
+                result.duration_sec = metadata.duration;
+                result.succeeded = writer.close(metadata);
+
+                if(result.succeeded && !is_native) {
+                    auto &&save_data = detail::load(writing_path, FileFormat::Native);
+                    result.succeeded = detail::save(result.path, std::move(save_data), format);
+                    if(result.succeeded) std::remove(writing_path.c_str());
+                    else ofLogError("ofxRecordOsc") << "failed to save data to " << result.path << ". edited data is remained at " << writing_path;
+                }
+                result.edit_duration_ms = detail::elapsed_nanos(started, std::chrono::steady_clock::now()) / 1000000.0;
+                return result;
+            }
+
+            Metadata mergedMetadata(const std::vector<std::unique_ptr<detail::edit_cursor>> &cursors,
+                                    std::int64_t first_shift_ns,
+                                    std::int64_t origin_ns,
+                                    std::int64_t duration_ns) const
+            {
+                const auto &first = cursors.front()->getReader().metadata();
+                Metadata metadata;
+                metadata.system_message = first.system_message;
+
+                bool all_whitelisted = true;
+                std::set<std::string> input_whitelists;
+                std::set<std::string> common_blacklists = first.blacklists;
+                for(const auto &cursor : cursors) {
+                    const auto &md = cursor->getReader().metadata();
+                    metadata.listening_ports.insert(md.listening_ports.begin(), md.listening_ports.end());
+                    if(md.whitelists.empty()) all_whitelisted = false;
+                    input_whitelists.insert(md.whitelists.begin(), md.whitelists.end());
+                    std::set<std::string> common;
+                    std::set_intersection(common_blacklists.begin(), common_blacklists.end(),
+                                          md.blacklists.begin(), md.blacklists.end(),
+                                          std::inserter(common, common.begin()));
+                    common_blacklists.swap(common);
+                }
+                // every output record matches either of them
+                if(!whitelists.empty()) metadata.whitelists = whitelists;
+                else if(all_whitelisted) metadata.whitelists = input_whitelists;
+                metadata.blacklists = common_blacklists;
+                metadata.blacklists.insert(blacklists.begin(), blacklists.end());
+
+                // offset 0 of first input is first_shift_ns on output
+                std::int64_t first_started_ns;
+                if(!detail::parse_timestamp_string(first.started_time_str, first_started_ns)) {
+                    first_started_ns = static_cast<std::int64_t>(first.started_timestamp) * 1000000000;
+                }
+                auto started_ns = first_started_ns + origin_ns - first_shift_ns;
+                auto finished_ns = started_ns + duration_ns;
+                metadata.started_time_str = detail::timestamp_string(started_ns);
+                metadata.started_timestamp = static_cast<std::uint32_t>(started_ns / 1000000000);
+                metadata.finished_time_str = detail::timestamp_string(finished_ns);
+                metadata.finished_timestamp = static_cast<std::uint32_t>(finished_ns / 1000000000);
+                metadata.duration = duration_ns / 1000000000.0;
+                metadata.duration_ns = duration_ns;
+                return metadata;
+            }
+        }; // struct RecordingEditor
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscEditor = ofx::RecordOsc::RecordingEditor;
+using ofxRecordOscEditResult = ofx::RecordOsc::EditResult;
+
+#endif /* ofxRecordOscEditor_h */
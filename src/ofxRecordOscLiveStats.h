@@ -0,0 +1,237 @@
+//
+//  ofxRecordOscLiveStats.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscLiveStats_h
+#define ofxRecordOscLiveStats_h
+
+#include "ofxRecordOscData.h"
+
+#include <atomic>
+#include <array>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+namespace ofx {
+    namespace RecordOsc {
+        // digest of received message for display
+        struct Digest {
+            std::int64_t offset_ns{0};
+            std::size_t num_args{0};
+            std::string address; // truncated to DigestRing::max_address_length
+
+            double offset() const
+            { return offset_ns / 1000000000.0; };
+        };
+
+        // fixed size ring of latest digests.
+        // push never allocates nor locks, digests are formatted only when they are read.
+        // each slot is guarded by sequence number (seqlock), a slot overwritten while reading is skipped.
+        struct DigestRing {
+            static constexpr std::size_t max_address_length = 56;
+
+            DigestRing(std::size_t capacity = 128)
+            { resize(capacity); };
+
+            DigestRing(const DigestRing &) = delete;
+            DigestRing &operator=(const DigestRing &) = delete;
+
+            // not thread safe. call before start using.
+            void resize(std::size_t capacity) {
+                std::size_t size = 2;
+                while(size < capacity) size <<= 1;
+                mask = size - 1;
+                slots.reset(new slot[size]);
+                head.store(0, std::memory_order_relaxed);
+            }
+
+            std::size_t capacity() const
+            { return mask + 1; };
+
+            void push(std::int64_t offset_ns, const std::string &address, std::size_t num_args) {
+                auto ticket = head.fetch_add(1, std::memory_order_relaxed);
+                auto &s = slots[ticket & mask];
+                // odd while writing
+                s.sequence.store(2 * ticket + 1, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_release);
+                s.offset_ns.store(offset_ns, std::memory_order_relaxed);
+                s.num_args.store(num_args, std::memory_order_relaxed);
+                std::array<std::uint64_t, num_words> words{};
+                auto length = (std::min)(address.length(), max_address_length);
+                std::memcpy(words.data(), address.data(), length);
+                s.address_length.store(length, std::memory_order_relaxed);
+                for(std::size_t i = 0; i < (length + 7) / 8; ++i) s.address[i].store(words[i], std::memory_order_relaxed);
+                s.sequence.store(2 * ticket + 2, std::memory_order_release);
+            }
+
+            // callback: void(const Digest &). from newest to oldest, at most max_digests
+            template <typename callback_t>
+            void forEachLatest(std::size_t max_digests, callback_t callback) const {
+                auto end = head.load(std::memory_order_acquire);
+                auto num = (std::min)({max_digests, static_cast<std::size_t>(end), capacity()});
+                Digest digest;
+                for(std::size_t n = 0; n < num; ++n) {
+                    auto ticket = end - 1 - n;
+                    const auto &s = slots[ticket & mask];
+                    if(s.sequence.load(std::memory_order_acquire) != 2 * ticket + 2) continue;
+                    digest.offset_ns = s.offset_ns.load(std::memory_order_relaxed);
+                    digest.num_args = s.num_args.load(std::memory_order_relaxed);
+                    std::array<std::uint64_t, num_words> words{};
+                    auto length = (std::min)(s.address_length.load(std::memory_order_relaxed), max_address_length);
+                    for(std::size_t i = 0; i < (length + 7) / 8; ++i) words[i] = s.address[i].load(std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_acquire);
+                    // overwritten while reading
+                    if(s.sequence.load(std::memory_order_relaxed) != 2 * ticket + 2) continue;
+                    digest.address.assign(reinterpret_cast<const char *>(words.data()), length);
+                    callback(digest);
+                }
+            }
+
+            std::uint64_t numPushed() const
+            { return head.load(std::memory_order_relaxed); };
+
+            void clear()
+            { head.store(0, std::memory_order_relaxed); };
+
+        private:
+            static constexpr std::size_t num_words = max_address_length / 8;
+            struct slot {
+                std::atomic<std::uint64_t> sequence{0};
+                std::atomic<std::int64_t> offset_ns{0};
+                std::atomic<std::size_t> num_args{0};
+                std::atomic<std::size_t> address_length{0};
+                std::array<std::atomic<std::uint64_t>, num_words> address{};
+            };
+            std::unique_ptr<slot[]> slots;
+            std::size_t mask{0};
+            std::atomic<std::uint64_t> head{0};
+        }; // struct DigestRing
+
+        // snapshot of live stats per address
+        struct AddressStats {
+            std::string address;
+            std::uint64_t num_messages{0};
+            double rate{0.0};            // messages per sec since previous snapshot
+            std::int64_t last_offset_ns{0};
+            double last_value{0.0};      // first argument, NaN if it is not numeric
+        };
+
+        // live count / last value per address.
+        // receiving threads touch only atomics of slot after the first message of address,
+        // slot of address is found by cache per receiving thread.
+        struct LiveAddressStats {
+        private:
+            struct slot {
+                std::string address;
+                std::atomic<std::uint64_t> num_messages{0};
+                std::atomic<std::int64_t> last_offset_ns{0};
+                std::atomic<double> last_value{0.0};
+                std::uint64_t num_messages_at_snapshot{0}; // guarded by mutex
+            };
+
+        public:
+            // address to slot. must be used only by one thread (e.g. per port)
+            struct Cache {
+                std::unordered_map<std::string, slot *> slots; // nullptr if address is not counted
+            };
+
+            // addresses over this are not counted
+            std::size_t max_addresses{4096};
+
+            void add(const std::string &address,
+                     const ofxOscMessageEx &mess,
+                     std::int64_t offset_ns,
+                     Cache &cache)
+            {
+                double value = 0 < mess.getNumArgs() ? detail::arg_as_double(mess, 0) : std::numeric_limits<double>::quiet_NaN();
+                add(address, value, offset_ns, cache);
+            }
+
+            // value: first argument, NaN if it is not numeric
+            void add(const std::string &address,
+                     double value,
+                     std::int64_t offset_ns,
+                     Cache &cache)
+            {
+                auto it = cache.slots.find(address);
+                slot *found;
+                if(it != cache.slots.end()) {
+                    found = it->second;
+                } else {
+                    found = findOrAddSlot(address);
+                    cache.slots.emplace(address, found);
+                }
+                if(found == nullptr) return;
+                auto &s = *found;
+                s.num_messages.fetch_add(1, std::memory_order_relaxed);
+                s.last_offset_ns.store(offset_ns, std::memory_order_relaxed);
+                s.last_value.store(value, std::memory_order_relaxed);
+            }
+
+            // rate is measured between calls, so call this periodically (e.g. on update)
+            std::vector<AddressStats> snapshot() {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                auto now = std::chrono::steady_clock::now();
+                double elapsed = std::chrono::duration<double>(now - snapshot_at).count();
+                snapshot_at = now;
+                std::vector<AddressStats> stats;
+                stats.reserve(slots.size());
+                for(auto &ptr : slots) {
+                    auto &s = *ptr;
+                    AddressStats st;
+                    st.address = s.address;
+                    st.num_messages = s.num_messages.load(std::memory_order_relaxed);
+                    st.last_offset_ns = s.last_offset_ns.load(std::memory_order_relaxed);
+                    st.last_value = s.last_value.load(std::memory_order_relaxed);
+                    auto delta = st.num_messages - (std::min)(st.num_messages, s.num_messages_at_snapshot);
+                    st.rate = 0.0 < elapsed ? delta / elapsed : 0.0;
+                    s.num_messages_at_snapshot = st.num_messages;
+                    stats.push_back(std::move(st));
+                }
+                return stats;
+            }
+
+            // counts are reset, known addresses are kept
+            void reset() {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                for(auto &ptr : slots) {
+                    ptr->num_messages.store(0, std::memory_order_relaxed);
+                    ptr->num_messages_at_snapshot = 0;
+                }
+                snapshot_at = std::chrono::steady_clock::now();
+            }
+
+        private:
+            std::mutex mutex;
+            // slot is never moved, receiving threads keep pointer in cache
+            std::vector<std::unique_ptr<slot>> slots;
+            std::unordered_map<std::string, slot *> indices;
+            std::chrono::steady_clock::time_point snapshot_at{std::chrono::steady_clock::now()};
+
+            // only for the first message of address per receiving thread
+            slot *findOrAddSlot(const std::string &address) {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                auto it = indices.find(address);
+                if(it != indices.end()) return it->second;
+                if(max_addresses <= slots.size()) return nullptr;
+                slots.emplace_back(new slot);
+                slots.back()->address = address;
+                indices.emplace(address, slots.back().get());
+                return slots.back().get();
+            }
+        }; // struct LiveAddressStats
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscDigest = ofx::RecordOsc::Digest;
+using ofxRecordOscDigestRing = ofx::RecordOsc::DigestRing;
+using ofxRecordOscAddressStats = ofx::RecordOsc::AddressStats;
+
+#endif /* ofxRecordOscLiveStats_h */
@@ -0,0 +1,138 @@
+//
+//  ofxRecordOscMappedFile.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscMappedFile_h
+#define ofxRecordOscMappedFile_h
+
+#include "ofConstants.h"
+#include "ofLog.h"
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef TARGET_WIN32
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <fcntl.h>
+#   include <unistd.h>
+#endif
+
+namespace ofx {
+    namespace RecordOsc {
+        // read only memory mapped file
+        struct MappedFile {
+            MappedFile() = default;
+            MappedFile(const MappedFile &) = delete;
+            MappedFile &operator=(const MappedFile &) = delete;
+            ~MappedFile()
+            { close(); };
+
+            bool open(const std::string &filepath) {
+                close();
+#ifdef TARGET_WIN32
+                file = CreateFileA(filepath.c_str(),
+                                   GENERIC_READ,
+                                   FILE_SHARE_READ | FILE_SHARE_WRITE,
+                                   nullptr,
+                                   OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL,
+                                   nullptr);
+                if(file == INVALID_HANDLE_VALUE) {
+                    ofLogError("ofxRecordOsc") << "can't open file: " << filepath << " on map.";
+                    return false;
+                }
+                LARGE_INTEGER file_size;
+                GetFileSizeEx(file, &file_size);
+                length = static_cast<std::size_t>(file_size.QuadPart);
+                if(length == 0) return true;
+                mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if(mapping == nullptr) {
+                    ofLogError("ofxRecordOsc") << "can't map file: " << filepath;
+                    close();
+                    return false;
+                }
+                address = static_cast<const std::uint8_t *>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+#else
+                fd = ::open(filepath.c_str(), O_RDONLY);
+                if(fd < 0) {
+                    ofLogError("ofxRecordOsc") << "can't open file: " << filepath << " on map.";
+                    return false;
+                }
+                struct stat stat_buf;
+                if(fstat(fd, &stat_buf) != 0) {
+                    ofLogError("ofxRecordOsc") << "can't stat file: " << filepath;
+                    close();
+                    return false;
+                }
+                length = static_cast<std::size_t>(stat_buf.st_size);
+                if(length == 0) return true;
+                void *p = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+                if(p == MAP_FAILED) {
+                    ofLogError("ofxRecordOsc") << "can't map file: " << filepath;
+                    close();
+                    return false;
+                }
+                address = static_cast<const std::uint8_t *>(p);
+#endif
+                if(address == nullptr) {
+                    ofLogError("ofxRecordOsc") << "can't map file: " << filepath;
+                    close();
+                    return false;
+                }
+                return true;
+            }
+
+            void close() {
+#ifdef TARGET_WIN32
+                if(address) UnmapViewOfFile(address);
+                if(mapping) CloseHandle(mapping);
+                if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+                mapping = nullptr;
+                file = INVALID_HANDLE_VALUE;
+#else
+                if(address) munmap(const_cast<std::uint8_t *>(address), length);
+                if(0 <= fd) ::close(fd);
+                fd = -1;
+#endif
+                address = nullptr;
+                length = 0;
+            }
+
+            // hint for kernel. e.g. playback reads file sequentially
+            void adviseSequential() const {
+#ifndef TARGET_WIN32
+                if(address) madvise(const_cast<std::uint8_t *>(address), length, MADV_SEQUENTIAL);
+#endif
+            }
+
+            bool isOpen() const
+#ifdef TARGET_WIN32
+            { return file != INVALID_HANDLE_VALUE; };
+#else
+            { return 0 <= fd; };
+#endif
+
+            const std::uint8_t *data() const
+            { return address; };
+
+            std::size_t size() const
+            { return length; };
+
+        private:
+            const std::uint8_t *address{nullptr};
+            std::size_t length{0};
+#ifdef TARGET_WIN32
+            HANDLE file{INVALID_HANDLE_VALUE};
+            HANDLE mapping{nullptr};
+#else
+            int fd{-1};
+#endif
+        }; // struct MappedFile
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+#endif /* ofxRecordOscMappedFile_h */
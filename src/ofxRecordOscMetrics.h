@@ -0,0 +1,216 @@
+//
+//  ofxRecordOscMetrics.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscMetrics_h
+#define ofxRecordOscMetrics_h
+
+#include "ofxOscMessageEx.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ofx {
+    namespace RecordOsc {
+        // lock-free histogram of durations in nanosec.
+        // bucket i counts durations in [2^i, 2^(i + 1)), so percentiles are accurate within factor 2.
+        struct LatencyHistogram {
+            static constexpr std::size_t num_buckets = 40; // up to about 18 min
+
+            struct Snapshot {
+                std::uint64_t count{0};
+                std::uint64_t sum_ns{0};
+                std::uint64_t max_ns{0};
+                std::array<std::uint64_t, num_buckets> buckets{};
+
+                double meanNanos() const
+                { return count ? static_cast<double>(sum_ns) / count : 0.0; };
+
+                // upper bound of bucket which includes p-th duration. p is in [0, 1]
+                std::uint64_t percentileNanos(double p) const {
+                    if(count == 0) return 0;
+                    auto rank = static_cast<std::uint64_t>(p * (count - 1)) + 1;
+                    std::uint64_t seen = 0;
+                    for(std::size_t i = 0; i < num_buckets; ++i) {
+                        seen += buckets[i];
+                        if(rank <= seen) return (std::min)(max_ns, (std::uint64_t{2} << i) - 1);
+                    }
+                    return max_ns;
+                }
+            };
+
+            LatencyHistogram() = default;
+            // copy is not atomic as a whole, it is only for copying owner (e.g. Player)
+            LatencyHistogram(const LatencyHistogram &x)
+            { *this = x; };
+            LatencyHistogram &operator=(const LatencyHistogram &x) {
+                for(std::size_t i = 0; i < num_buckets; ++i) {
+                    buckets[i].store(x.buckets[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+                }
+                sum_ns.store(x.sum_ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                max_ns.store(x.max_ns.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                return *this;
+            }
+
+            void record(std::int64_t duration_ns) {
+                auto ns = static_cast<std::uint64_t>(0 < duration_ns ? duration_ns : 0);
+                buckets[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+                sum_ns.fetch_add(ns, std::memory_order_relaxed);
+                auto current = max_ns.load(std::memory_order_relaxed);
+                while(current < ns && !max_ns.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {}
+            }
+
+            Snapshot snapshot() const {
+                Snapshot s;
+                for(std::size_t i = 0; i < num_buckets; ++i) {
+                    s.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+                    s.count += s.buckets[i];
+                }
+                s.sum_ns = sum_ns.load(std::memory_order_relaxed);
+                s.max_ns = max_ns.load(std::memory_order_relaxed);
+                return s;
+            }
+
+            void reset() {
+                for(auto &bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+                sum_ns.store(0, std::memory_order_relaxed);
+                max_ns.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            std::array<std::atomic<std::uint64_t>, num_buckets> buckets{};
+            std::atomic<std::uint64_t> sum_ns{0};
+            std::atomic<std::uint64_t> max_ns{0};
+
+            static std::size_t bucketOf(std::uint64_t ns) {
+                std::size_t i = 0;
+                while(1 < ns && i + 1 < num_buckets) {
+                    ns >>= 1;
+                    ++i;
+                }
+                return i;
+            }
+        }; // struct LatencyHistogram
+
+        // snapshot of Recorder::getMetrics
+        struct RecorderMetrics {
+            // counts of messages while recording
+            std::uint64_t num_received{0}; // arrived while recording, except start message
+            std::uint64_t num_filtered{0}; // rejected by whitelists / blacklists
+            std::uint64_t num_accepted{0}; // pushed to queue
+            std::uint64_t num_dropped{0};  // queue was full
+            std::uint64_t num_written{0};  // appended to writer
+            std::uint64_t num_rotations{0};
+
+            std::size_t queue_depth{0};
+            std::size_t queue_capacity{0};
+            // busy time of workers / (elapsed time * number of workers)
+            double worker_utilization{0.0};
+            double elapsed_sec{0.0}; // since resetMetrics
+
+            LatencyHistogram::Snapshot receive; // from capture of time to push to queue
+            LatencyHistogram::Snapshot filter;  // from capture of time to decision of whitelists / blacklists
+            LatencyHistogram::Snapshot convert; // encoding of a record by worker
+            LatencyHistogram::Snapshot write;   // passing a batch to writer, including wait for lock
+            double last_save_duration_ms{0.0};
+        }; // struct RecorderMetrics
+
+        // snapshot of Player::getMetrics
+        struct PlayerMetrics {
+            double load_duration_ms{0.0};
+            std::uint64_t num_iterations{0};
+            std::uint64_t num_iterated_records{0};
+            LatencyHistogram::Snapshot iterate; // a call of forEachInRangeNanos including callbacks
+        }; // struct PlayerMetrics
+
+        namespace detail {
+            // relaxed atomic counter which can be copied with owner
+            struct counter {
+                counter() = default;
+                counter(const counter &x)
+                : value(x.load()) {}
+                counter &operator=(const counter &x) {
+                    value.store(x.load(), std::memory_order_relaxed);
+                    return *this;
+                }
+
+                void add(std::uint64_t n)
+                { value.fetch_add(n, std::memory_order_relaxed); };
+                std::uint64_t load() const
+                { return value.load(std::memory_order_relaxed); };
+                void reset()
+                { value.store(0, std::memory_order_relaxed); };
+
+            private:
+                std::atomic<std::uint64_t> value{0};
+            };
+
+            inline std::int64_t elapsed_nanos(std::chrono::steady_clock::time_point from,
+                                              std::chrono::steady_clock::time_point to)
+            { return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count(); };
+
+            // [count, mean, p50, p99, max] in microsec
+            inline ofxOscMessage to_message(const std::string &address,
+                                            const LatencyHistogram::Snapshot &histogram)
+            {
+                ofxOscMessage m;
+                m.setAddress(address);
+                m.addInt64Arg(static_cast<std::int64_t>(histogram.count));
+                m.addFloatArg(histogram.meanNanos() / 1000.0);
+                m.addFloatArg(histogram.percentileNanos(0.5) / 1000.0);
+                m.addFloatArg(histogram.percentileNanos(0.99) / 1000.0);
+                m.addFloatArg(histogram.max_ns / 1000.0);
+                return m;
+            }
+
+            // messages published by Recorder::publishMetrics
+            inline std::vector<ofxOscMessage> to_messages(const std::string &prefix,
+                                                          const RecorderMetrics &metrics)
+            {
+                std::vector<ofxOscMessage> messages;
+                ofxOscMessage counts;
+                counts.setAddress(prefix + "/counts");
+                counts.addInt64Arg(static_cast<std::int64_t>(metrics.num_received));
+                counts.addInt64Arg(static_cast<std::int64_t>(metrics.num_filtered));
+                counts.addInt64Arg(static_cast<std::int64_t>(metrics.num_accepted));
+                counts.addInt64Arg(static_cast<std::int64_t>(metrics.num_dropped));
+                counts.addInt64Arg(static_cast<std::int64_t>(metrics.num_written));
+                messages.push_back(counts);
+
+                ofxOscMessage queue;
+                queue.setAddress(prefix + "/queue");
+                queue.addInt64Arg(static_cast<std::int64_t>(metrics.queue_depth));
+                queue.addInt64Arg(static_cast<std::int64_t>(metrics.queue_capacity));
+                messages.push_back(queue);
+
+                ofxOscMessage utilization;
+                utilization.setAddress(prefix + "/worker_utilization");
+                utilization.addFloatArg(static_cast<float>(metrics.worker_utilization));
+                messages.push_back(utilization);
+
+                messages.push_back(to_message(prefix + "/latency/receive", metrics.receive));
+                messages.push_back(to_message(prefix + "/latency/filter", metrics.filter));
+                messages.push_back(to_message(prefix + "/latency/convert", metrics.convert));
+                messages.push_back(to_message(prefix + "/latency/write", metrics.write));
+
+                ofxOscMessage save;
+                save.setAddress(prefix + "/last_save_duration_ms");
+                save.addFloatArg(static_cast<float>(metrics.last_save_duration_ms));
+                messages.push_back(save);
+                return messages;
+            }
+        }; // namespace detail
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscLatencyHistogram = ofx::RecordOsc::LatencyHistogram;
+using ofxRecordOscRecorderMetrics = ofx::RecordOsc::RecorderMetrics;
+using ofxRecordOscPlayerMetrics = ofx::RecordOsc::PlayerMetrics;
+
+#endif /* ofxRecordOscMetrics_h */
@@ -0,0 +1,2296 @@
+//
+//  ofxRecordOscNativeFormat.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscNativeFormat_h
+#define ofxRecordOscNativeFormat_h
+
+#include "ofxOscMessageExJsonConversion.h"
+#include "ofxRecordOscData.h"
+#include "ofxRecordOscMappedFile.h"
+#include "ofxRecordOscPacket.h"
+
+#include "ofLog.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <string>
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <unordered_map>
+
+#ifdef OFX_RECORD_OSC_USE_LZ4
+#   include <lz4.h>
+#endif
+#ifdef OFX_RECORD_OSC_USE_ZSTD
+#   include <zstd.h>
+#endif
+
+namespace ofx {
+    namespace RecordOsc {
+        namespace detail {
+            namespace native {
+                // file layout (all integers are little endian)
+                //
+                //   header : magic(8) version(u32)
+                //   chunk* : tag(u32) size(u32) payload(size)
+                //     META : cbor encoded metadata at the time recording started
+                //     DICT : num_entries(u32) { kind(u8) id(varint) value }*
+                //       kind 0 (address)  : address(string16)
+                //       kind 1 (endpoint) : host(string16) port(u16)
+                //       written before RECS chunk which refers its entries.
+                //     RECS : num_records(u32) { size(u32) record(size) }*
+                //       record (version 1) : offset[sec](f64) message
+                //       record (version 2) : offset[nanosec](i64) timetag(u64) message
+                //       record (version 3) : offset[nanosec](i64) timetag(u64) message with interned strings
+                //         message (version 1, 2) : address(string16) host(string16) port(u16) received_port(u16) args
+                //         message (version 3)    : address_id(varint) endpoint_id(varint) received_port(u16) args
+                //     RECZ : num_records(u32) first_offset[nanosec](i64) codec(u8) delta_size(u32) body (version 5)
+                //       compressed RECS. body is delta stream compressed by codec (0: none, 1: LZ4, 2: Zstd)
+                //       delta stream : { record }*
+                //         record : zigzag(offset - previous offset)(varint) zigzag(timetag - previous timetag)(varint)
+                //                  address_id(varint) endpoint_id(varint) received_port(varint) num_args(varint) { type(u8) value }*
+                //         value of int32, int64, timetag : zigzag(value - previous value of same address and argument)(varint)
+                //         value of float, double         : (bits xor previous bits of same address and argument)(varint)
+                //         value of string, symbol, blob  : length(varint) bytes
+                //         others                         : same as RECS
+                //       previous values are reset per chunk, so each chunk can be decoded independently.
+                //     PKTS : num_messages(u32) { size(u32) packet }* (version 6)
+                //       raw OSC datagrams recorded by Recorder::listenRaw, never compressed.
+                //       packet : offset[nanosec](i64) endpoint_id(varint) received_port(u16)
+                //                num_messages(varint) { address_id(varint) }* bytes(rest of packet)
+                //       address ids are in order of messages in bytes (bundles are flattened).
+                //       messages are decoded into records of version 3 on reading, num_records of INDX counts messages.
+                //     INDX : interval[nanosec](i64) num_entries(u32) { position(u64) size(u32) num_records(u32) min_offset(i64) max_offset(i64) }*
+                //       one entry per RECS / RECZ / PKTS chunk. position is head of chunk. (version 4)
+                //     TAIL (version 1 - 3) : num_records(u64) cbor encoded metadata at the time recording finished
+                //     TAIL (version 4)     : num_records(u64) position of INDX(u64) position of last DICT(u64) metadata
+                //       last DICT has all entries. position is 0 if chunk is not written.
+                //   footer : position of TAIL chunk(u64) magic(8)
+                //
+                // RECS chunks are appended while recording,
+                // so a file without TAIL (e.g. crashed) is still readable.
+                // finalized file can be opened from footer without scanning chunks.
+
+                constexpr char header_magic[8] = {'o', 'f', 'x', 'R', 'O', 'S', 'C', '\0'};
+                constexpr char footer_magic[8] = {'o', 'f', 'x', 'R', 'O', 'S', 'C', '$'};
+                constexpr std::uint32_t version = 6;
+                constexpr std::size_t header_size = 12;
+                constexpr std::size_t chunk_header_size = 8;
+                constexpr std::size_t footer_size = 16;
+
+                constexpr std::uint32_t make_tag(char a, char b, char c, char d) {
+                    return static_cast<std::uint32_t>(static_cast<std::uint8_t>(a))
+                        | (static_cast<std::uint32_t>(static_cast<std::uint8_t>(b)) << 8)
+                        | (static_cast<std::uint32_t>(static_cast<std::uint8_t>(c)) << 16)
+                        | (static_cast<std::uint32_t>(static_cast<std::uint8_t>(d)) << 24);
+                }
+
+                constexpr std::uint32_t tag_metadata   = make_tag('M', 'E', 'T', 'A');
+                constexpr std::uint32_t tag_dictionary = make_tag('D', 'I', 'C', 'T');
+                constexpr std::uint32_t tag_records    = make_tag('R', 'E', 'C', 'S');
+                constexpr std::uint32_t tag_compressed_records = make_tag('R', 'E', 'C', 'Z');
+                constexpr std::uint32_t tag_packets    = make_tag('P', 'K', 'T', 'S');
+                constexpr std::uint32_t tag_index      = make_tag('I', 'N', 'D', 'X');
+                constexpr std::uint32_t tag_trailer    = make_tag('T', 'A', 'I', 'L');
+
+                struct binary_writer {
+                    binary_writer(std::vector<std::uint8_t> &buffer)
+                    : buffer(buffer) {}
+
+                    template <typename uint_type>
+                    void write_le(uint_type value) {
+                        auto position = buffer.size();
+                        buffer.resize(position + sizeof(uint_type));
+                        auto p = buffer.data() + position;
+                        for(std::size_t i = 0; i < sizeof(uint_type); ++i) {
+                            p[i] = static_cast<std::uint8_t>(value >> (8 * i));
+                        }
+                    }
+
+                    void write_u8(std::uint8_t value)   { buffer.push_back(value); };
+                    void write_u16(std::uint16_t value) { write_le(value); };
+                    void write_u32(std::uint32_t value) { write_le(value); };
+                    void write_u64(std::uint64_t value) { write_le(value); };
+                    void write_i32(std::int32_t value)  { write_le(static_cast<std::uint32_t>(value)); };
+                    void write_i64(std::int64_t value)  { write_le(static_cast<std::uint64_t>(value)); };
+                    void write_f32(float value) {
+                        std::uint32_t bits;
+                        std::memcpy(&bits, &value, sizeof(bits));
+                        write_le(bits);
+                    }
+                    void write_f64(double value) {
+                        std::uint64_t bits;
+                        std::memcpy(&bits, &value, sizeof(bits));
+                        write_le(bits);
+                    }
+                    void write_bytes(const void *data, std::size_t size) {
+                        auto &&p = static_cast<const std::uint8_t *>(data);
+                        buffer.insert(buffer.end(), p, p + size);
+                    }
+                    void write_varint(std::uint64_t value) {
+                        while(0x80 <= value) {
+                            buffer.push_back(static_cast<std::uint8_t>(value | 0x80));
+                            value >>= 7;
+                        }
+                        buffer.push_back(static_cast<std::uint8_t>(value));
+                    }
+                    void write_string16(const std::string &str) {
+                        write_u16(static_cast<std::uint16_t>(str.length()));
+                        write_bytes(str.data(), static_cast<std::uint16_t>(str.length()));
+                    }
+                    void write_string32(const std::string &str) {
+                        write_u32(static_cast<std::uint32_t>(str.length()));
+                        write_bytes(str.data(), str.length());
+                    }
+
+                    void patch_u32(std::size_t position, std::uint32_t value) {
+                        for(std::size_t i = 0; i < 4; ++i) {
+                            buffer[position + i] = static_cast<std::uint8_t>(value >> (8 * i));
+                        }
+                    }
+
+                    std::size_t size() const
+                    { return buffer.size(); };
+
+                    std::vector<std::uint8_t> &buffer;
+                }; // struct binary_writer
+
+                struct binary_reader {
+                    binary_reader(const std::uint8_t *data, std::size_t size)
+                    : data(data)
+                    , size(size) {}
+
+                    bool good() const
+                    { return !failed; };
+                    std::size_t position() const
+                    { return pos; };
+                    std::size_t remaining() const
+                    { return size - pos; };
+
+                    template <typename uint_type>
+                    uint_type read_le() {
+                        if(!require(sizeof(uint_type))) return 0;
+                        uint_type value = 0;
+                        for(std::size_t i = 0; i < sizeof(uint_type); ++i) {
+                            value |= static_cast<uint_type>(data[pos + i]) << (8 * i);
+                        }
+                        pos += sizeof(uint_type);
+                        return value;
+                    }
+
+                    std::uint8_t read_u8()   { return read_le<std::uint8_t>(); };
+                    std::uint16_t read_u16() { return read_le<std::uint16_t>(); };
+                    std::uint32_t read_u32() { return read_le<std::uint32_t>(); };
+                    std::uint64_t read_u64() { return read_le<std::uint64_t>(); };
+                    std::int32_t read_i32()  { return static_cast<std::int32_t>(read_le<std::uint32_t>()); };
+                    std::int64_t read_i64()  { return static_cast<std::int64_t>(read_le<std::uint64_t>()); };
+                    float read_f32() {
+                        auto bits = read_le<std::uint32_t>();
+                        float value;
+                        std::memcpy(&value, &bits, sizeof(value));
+                        return value;
+                    }
+                    double read_f64() {
+                        auto bits = read_le<std::uint64_t>();
+                        double value;
+                        std::memcpy(&value, &bits, sizeof(value));
+                        return value;
+                    }
+                    std::uint64_t read_varint() {
+                        std::uint64_t value = 0;
+                        for(std::size_t shift = 0; shift < 64; shift += 7) {
+                            if(!require(1)) return 0;
+                            auto byte = data[pos++];
+                            value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+                            if((byte & 0x80) == 0) return value;
+                        }
+                        failed = true;
+                        return 0;
+                    }
+                    const std::uint8_t *read_bytes(std::size_t length) {
+                        if(!require(length)) return nullptr;
+                        auto p = data + pos;
+                        pos += length;
+                        return p;
+                    }
+                    std::string read_string16() {
+                        auto length = read_u16();
+                        auto p = read_bytes(length);
+                        return p ? std::string(reinterpret_cast<const char *>(p), length) : std::string{};
+                    }
+                    std::string read_string32() {
+                        auto length = read_u32();
+                        auto p = read_bytes(length);
+                        return p ? std::string(reinterpret_cast<const char *>(p), length) : std::string{};
+                    }
+
+                    const std::uint8_t *data;
+                    std::size_t size;
+                    std::size_t pos{0};
+                    bool failed{false};
+
+                private:
+                    bool require(std::size_t length) {
+                        if(failed || size - pos < length) {
+                            failed = true;
+                            return false;
+                        }
+                        return true;
+                    }
+                }; // struct binary_reader
+
+                struct trailer_positions {
+                    std::uint64_t num_records{0};
+                    std::uint64_t index{0};
+                    std::uint64_t dictionary{0};
+                };
+
+                // reads head of TAIL payload. reader is moved to metadata
+                inline trailer_positions read_trailer_positions(binary_reader &reader,
+                                                                std::uint32_t file_version)
+                {
+                    trailer_positions positions;
+                    positions.num_records = reader.read_u64();
+                    if(4 <= file_version) {
+                        positions.index = reader.read_u64();
+                        positions.dictionary = reader.read_u64();
+                    }
+                    return positions;
+                }
+
+#pragma mark dictionary
+
+                constexpr std::uint8_t dictionary_address = 0;
+                constexpr std::uint8_t dictionary_endpoint = 1;
+
+                // ids of addresses and endpoints for writing. shared by all workers.
+                struct intern_table {
+                    std::uint32_t address(const std::string &address) {
+                        auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                        auto it = address_ids.find(address);
+                        if(it != address_ids.end()) return it->second;
+                        std::uint32_t id = static_cast<std::uint32_t>(address_ids.size());
+                        address_ids.emplace(address, id);
+                        auto position = pending.size();
+                        binary_writer writer{pending};
+                        writer.write_u8(dictionary_address);
+                        writer.write_varint(id);
+                        writer.write_string16(address);
+                        commit(position);
+                        return id;
+                    }
+
+                    std::uint32_t endpoint(const std::string &host, std::uint16_t port) {
+                        auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                        auto &&ports = endpoint_ids[host];
+                        for(const auto &p : ports) if(p.first == port) return p.second;
+                        std::uint32_t id = num_endpoints++;
+                        ports.emplace_back(port, id);
+                        auto position = pending.size();
+                        binary_writer writer{pending};
+                        writer.write_u8(dictionary_endpoint);
+                        writer.write_varint(id);
+                        writer.write_string16(host);
+                        writer.write_u16(port);
+                        commit(position);
+                        return id;
+                    }
+
+                    // takes payload of DICT chunk made of entries added after last call
+                    bool take(std::vector<std::uint8_t> &payload) {
+                        auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                        if(num_pending == 0) return false;
+                        payload.clear();
+                        binary_writer writer{payload};
+                        writer.write_u32(num_pending);
+                        writer.write_bytes(pending.data(), pending.size());
+                        pending.clear();
+                        num_pending = 0;
+                        return true;
+                    }
+
+                    // takes payload of DICT chunk made of all entries.
+                    // it is written at head of new segment, so ids are kept across segments.
+                    bool snapshot(std::vector<std::uint8_t> &payload) {
+                        auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                        pending.clear();
+                        num_pending = 0;
+                        if(num_entries == 0) return false;
+                        payload.clear();
+                        binary_writer writer{payload};
+                        writer.write_u32(num_entries);
+                        writer.write_bytes(entries.data(), entries.size());
+                        return true;
+                    }
+
+                    void reset() {
+                        auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                        address_ids.clear();
+                        endpoint_ids.clear();
+                        num_endpoints = 0;
+                        pending.clear();
+                        num_pending = 0;
+                        entries.clear();
+                        num_entries = 0;
+                        ++generation;
+                    }
+
+                    std::uint64_t currentGeneration() const
+                    { return generation; };
+
+                private:
+                    std::mutex mutex;
+                    std::unordered_map<std::string, std::uint32_t> address_ids;
+                    std::unordered_map<std::string, std::vector<std::pair<std::uint16_t, std::uint32_t>>> endpoint_ids;
+                    std::uint32_t num_endpoints{0};
+                    std::vector<std::uint8_t> pending;
+                    std::uint32_t num_pending{0};
+                    std::vector<std::uint8_t> entries;
+                    std::uint32_t num_entries{0};
+                    std::atomic<std::uint64_t> generation{0};
+
+                    // entry is written to pending from position
+                    void commit(std::size_t position) {
+                        entries.insert(entries.end(), pending.begin() + position, pending.end());
+                        ++num_entries;
+                        ++num_pending;
+                    }
+                }; // struct intern_table
+
+                // per-thread cache of intern_table. hit costs one hash lookup without lock.
+                struct intern_cache {
+                    intern_cache(intern_table &table)
+                    : table(table) {}
+
+                    std::uint32_t address(const std::string &address) {
+                        sync();
+                        auto it = address_ids.find(address);
+                        if(it != address_ids.end()) return it->second;
+                        auto id = table.address(address);
+                        address_ids.emplace(address, id);
+                        return id;
+                    }
+
+                    // for address in OSC packet. no allocation for known address
+                    std::uint32_t address(const char *address, std::size_t length) {
+                        scratch.assign(address, length);
+                        return this->address(scratch);
+                    }
+
+                    std::uint32_t endpoint(const std::string &host, std::uint16_t port) {
+                        sync();
+                        auto &&ports = endpoint_ids[host];
+                        for(const auto &p : ports) if(p.first == port) return p.second;
+                        auto id = table.endpoint(host, port);
+                        ports.emplace_back(port, id);
+                        return id;
+                    }
+
+                private:
+                    intern_table &table;
+                    std::uint64_t generation{0};
+                    std::unordered_map<std::string, std::uint32_t> address_ids;
+                    std::unordered_map<std::string, std::vector<std::pair<std::uint16_t, std::uint32_t>>> endpoint_ids;
+                    std::string scratch;
+
+                    void sync() {
+                        auto current = table.currentGeneration();
+                        if(current == generation) return;
+                        address_ids.clear();
+                        endpoint_ids.clear();
+                        generation = current;
+                    }
+                }; // struct intern_cache
+
+                // ids of addresses and endpoints for reading
+                struct dictionary {
+                    std::vector<std::string> addresses;
+                    std::vector<std::pair<std::string, std::uint16_t>> endpoints;
+
+                    void clear() {
+                        addresses.clear();
+                        endpoints.clear();
+                    }
+
+                    bool read(const std::uint8_t *data, std::size_t size) {
+                        binary_reader reader{data, size};
+                        auto num_entries = reader.read_u32();
+                        for(std::uint32_t i = 0; i < num_entries && reader.good(); ++i) {
+                            auto kind = reader.read_u8();
+                            auto id = static_cast<std::size_t>(reader.read_varint());
+                            if(kind == dictionary_address) {
+                                if(addresses.size() <= id) addresses.resize(id + 1);
+                                addresses[id] = reader.read_string16();
+                            } else if(kind == dictionary_endpoint) {
+                                if(endpoints.size() <= id) endpoints.resize(id + 1);
+                                endpoints[id].first = reader.read_string16();
+                                endpoints[id].second = reader.read_u16();
+                            } else {
+                                ofLogWarning("ofxRecordOsc") << "unknown kind of dictionary entry: " << (int)kind;
+                                return false;
+                            }
+                        }
+                        return reader.good();
+                    }
+                }; // struct dictionary
+
+#pragma mark record
+
+                inline void write_arguments(binary_writer &writer,
+                                            const ofxOscMessageEx &mess)
+                {
+                    writer.write_u16(static_cast<std::uint16_t>(mess.getNumArgs()));
+                    for(std::size_t i = 0; i < mess.getNumArgs(); ++i) {
+                        auto type = mess.getArgType(i);
+                        writer.write_u8(static_cast<std::uint8_t>(type));
+                        switch(type) {
+                            case OFXOSC_TYPE_INT32:
+                                writer.write_i32(mess.getArgAsInt32(i));
+                                break;
+                            case OFXOSC_TYPE_CHAR:
+                                writer.write_u8(static_cast<std::uint8_t>(mess.getArgAsChar(i)));
+                                break;
+                            case OFXOSC_TYPE_INT64:
+                                writer.write_i64(mess.getArgAsInt64(i));
+                                break;
+                            case OFXOSC_TYPE_FLOAT:
+                                writer.write_f32(mess.getArgAsFloat(i));
+                                break;
+                            case OFXOSC_TYPE_DOUBLE:
+                                writer.write_f64(mess.getArgAsDouble(i));
+                                break;
+                            case OFXOSC_TYPE_STRING:
+                            case OFXOSC_TYPE_SYMBOL:
+                                writer.write_string32(mess.getArgAsString(i));
+                                break;
+                            case OFXOSC_TYPE_MIDI_MESSAGE:
+                                writer.write_u32(mess.getArgAsMidiMessage(i));
+                                break;
+                            case OFXOSC_TYPE_TIMETAG:
+                                writer.write_u64(mess.getArgAsTimetag(i));
+                                break;
+                            case OFXOSC_TYPE_BLOB: {
+                                auto &&blob = mess.getArgAsBlob(i);
+                                writer.write_u32(static_cast<std::uint32_t>(blob.size()));
+                                writer.write_bytes(blob.getData(), blob.size());
+                                break;
+                            }
+                            case OFXOSC_TYPE_RGBA_COLOR:
+                                writer.write_u32(mess.getArgAsRgbaColor(i));
+                                break;
+                            case OFXOSC_TYPE_TRUE:
+                            case OFXOSC_TYPE_FALSE:
+                            case OFXOSC_TYPE_NONE:
+                            case OFXOSC_TYPE_TRIGGER:
+                            case OFXOSC_TYPE_INDEXOUTOFBOUNDS:
+                                break;
+                        }
+                    }
+                }
+
+                inline void write_message(binary_writer &writer,
+                                          const ofxOscMessageEx &mess,
+                                          intern_cache &cache)
+                {
+                    writer.write_varint(cache.address(mess.getAddress()));
+                    writer.write_varint(cache.endpoint(mess.getRemoteHost(),
+                                                       static_cast<std::uint16_t>(mess.getRemotePort())));
+                    writer.write_u16(mess.getWaitingPort());
+                    write_arguments(writer, mess);
+                }
+
+                inline bool read_arguments(binary_reader &reader,
+                                           ofxOscMessageEx &mess)
+                {
+                    auto num_args = reader.read_u16();
+                    for(std::size_t i = 0; i < num_args && reader.good(); ++i) {
+                        switch(static_cast<ofxOscArgType>(reader.read_u8())) {
+                            case OFXOSC_TYPE_INT32:
+                                mess.addInt32Arg(reader.read_i32());
+                                break;
+                            case OFXOSC_TYPE_CHAR:
+                                mess.addCharArg(static_cast<char>(reader.read_u8()));
+                                break;
+                            case OFXOSC_TYPE_INT64:
+                                mess.addInt64Arg(reader.read_i64());
+                                break;
+                            case OFXOSC_TYPE_FLOAT:
+                                mess.addFloatArg(reader.read_f32());
+                                break;
+                            case OFXOSC_TYPE_DOUBLE:
+                                mess.addDoubleArg(reader.read_f64());
+                                break;
+                            case OFXOSC_TYPE_STRING:
+                                mess.addStringArg(reader.read_string32());
+                                break;
+                            case OFXOSC_TYPE_SYMBOL:
+                                mess.addSymbolArg(reader.read_string32());
+                                break;
+                            case OFXOSC_TYPE_MIDI_MESSAGE:
+                                mess.addMidiMessageArg(reader.read_u32());
+                                break;
+                            case OFXOSC_TYPE_TRUE:
+                                mess.addBoolArg(true);
+                                break;
+                            case OFXOSC_TYPE_FALSE:
+                                mess.addBoolArg(false);
+                                break;
+                            case OFXOSC_TYPE_TIMETAG:
+                                mess.addTimetagArg(reader.read_u64());
+                                break;
+                            case OFXOSC_TYPE_BLOB: {
+                                auto length = reader.read_u32();
+                                auto p = reader.read_bytes(length);
+                                if(p) mess.addBlobArg(ofBuffer{reinterpret_cast<const char *>(p), length});
+                                break;
+                            }
+                            case OFXOSC_TYPE_RGBA_COLOR:
+                                mess.addRgbaColorArg(reader.read_u32());
+                                break;
+                            case OFXOSC_TYPE_NONE:
+                                mess.addNoneArg();
+                                break;
+                            case OFXOSC_TYPE_TRIGGER:
+                                mess.addTriggerArg();
+                                break;
+                            default:
+                                ofLogWarning("ofxRecordOsc") << "unknown argument type in record of " << mess.getAddress();
+                                return false;
+                        }
+                    }
+                    return reader.good();
+                }
+
+                inline bool read_message(binary_reader &reader,
+                                         ofxOscMessageEx &mess,
+                                         std::uint32_t file_version,
+                                         const dictionary &dict,
+                                         std::uint32_t &address_id)
+                {
+                    mess.clear();
+                    if(file_version < 3) {
+                        mess.setAddress(reader.read_string16());
+                        auto &&host = reader.read_string16();
+                        auto port = reader.read_u16();
+                        mess.setRemoteEndpoint(host, port);
+                        address_id = SequenceData::unknown_address_id;
+                    } else {
+                        address_id = static_cast<std::uint32_t>(reader.read_varint());
+                        auto endpoint_id = static_cast<std::size_t>(reader.read_varint());
+                        if(dict.addresses.size() <= address_id || dict.endpoints.size() <= endpoint_id) {
+                            ofLogWarning("ofxRecordOsc") << "record refers unknown dictionary entry.";
+                            return false;
+                        }
+                        mess.setAddress(dict.addresses[address_id]);
+                        const auto &endpoint = dict.endpoints[endpoint_id];
+                        mess.setRemoteEndpoint(endpoint.first, endpoint.second);
+                    }
+                    mess.setWaitingPort(reader.read_u16());
+                    return read_arguments(reader, mess);
+                }
+
+                // appends size(u32) + record to buffer
+                inline void write_record(std::vector<std::uint8_t> &buffer,
+                                         std::int64_t offset_ns,
+                                         std::uint64_t timetag,
+                                         const ofxOscMessageEx &mess,
+                                         intern_cache &cache)
+                {
+                    binary_writer writer{buffer};
+                    auto size_position = writer.size();
+                    writer.write_u32(0);
+                    writer.write_i64(offset_ns);
+                    writer.write_u64(timetag);
+                    write_message(writer, mess, cache);
+                    writer.patch_u32(size_position,
+                                     static_cast<std::uint32_t>(writer.size() - size_position - 4));
+                }
+
+                inline bool read_record(binary_reader &reader,
+                                        SequenceData &data,
+                                        std::uint32_t file_version,
+                                        const dictionary &dict)
+                {
+                    if(file_version < 2) {
+                        data.setOffset(reader.read_f64());
+                        data.timetag = 0;
+                    } else {
+                        data.setOffsetNanos(reader.read_i64());
+                        data.timetag = reader.read_u64();
+                    }
+                    return read_message(reader, data.mess, file_version, dict, data.address_id);
+                }
+
+#pragma mark packet
+
+                // appends size(u32) + packet to buffer. returns number of messages in packet.
+                // addresses are interned, so messages of packet can be skipped by address id as same as records.
+                inline std::size_t write_packet(std::vector<std::uint8_t> &buffer,
+                                                std::int64_t offset_ns,
+                                                const std::uint8_t *bytes,
+                                                std::size_t size,
+                                                const std::string &host,
+                                                std::uint16_t port,
+                                                std::uint16_t received_port,
+                                                intern_cache &cache)
+                {
+                    std::size_t num_messages = 0;
+                    osc::for_each_message(bytes, size, [&num_messages](const osc::message_view &) {
+                        ++num_messages;
+                    });
+                    binary_writer writer{buffer};
+                    auto size_position = writer.size();
+                    writer.write_u32(0);
+                    writer.write_i64(offset_ns);
+                    writer.write_varint(cache.endpoint(host, port));
+                    writer.write_u16(received_port);
+                    writer.write_varint(num_messages);
+                    osc::for_each_message(bytes, size, [&](const osc::message_view &m) {
+                        writer.write_varint(cache.address(m.address, m.address_length));
+                    });
+                    writer.write_bytes(bytes, size);
+                    writer.patch_u32(size_position,
+                                     static_cast<std::uint32_t>(writer.size() - size_position - 4));
+                    return num_messages;
+                }
+
+                inline std::size_t write_packet(std::vector<std::uint8_t> &buffer,
+                                                const RawPacket &packet,
+                                                intern_cache &cache)
+                {
+                    return write_packet(buffer,
+                                        packet.offset_ns,
+                                        packet.bytes.data(),
+                                        packet.bytes.size(),
+                                        packet.host,
+                                        packet.port,
+                                        packet.received_port,
+                                        cache);
+                }
+
+                struct packet_header {
+                    std::int64_t offset_ns{0};
+                    std::uint32_t endpoint_id{0};
+                    std::uint16_t received_port{0};
+                    std::uint32_t num_messages{0};
+                };
+
+                // reader is moved to head of address ids
+                inline bool read_packet_header(binary_reader &reader,
+                                               packet_header &header)
+                {
+                    header.offset_ns = reader.read_i64();
+                    header.endpoint_id = static_cast<std::uint32_t>(reader.read_varint());
+                    header.received_port = reader.read_u16();
+                    header.num_messages = static_cast<std::uint32_t>(reader.read_varint());
+                    return reader.good();
+                }
+
+                // arguments of OSC message in layout of record.
+                // arguments after unsupported type (e.g. array) are dropped.
+                inline void write_osc_arguments(binary_writer &writer,
+                                                const osc::message_view &message)
+                {
+                    auto num_position = writer.size();
+                    writer.write_u16(0);
+                    std::uint16_t num_args = 0;
+                    auto p = message.arguments;
+                    const auto end = message.end;
+                    for(std::size_t i = 0; i < message.num_typetags; ++i) {
+                        auto remaining = static_cast<std::size_t>(end - p);
+                        auto type = static_cast<ofxOscArgType>(message.typetags[i]);
+                        std::size_t fixed_size = 0;
+                        switch(type) {
+                            case OFXOSC_TYPE_INT32:
+                            case OFXOSC_TYPE_CHAR:
+                            case OFXOSC_TYPE_FLOAT:
+                            case OFXOSC_TYPE_MIDI_MESSAGE:
+                            case OFXOSC_TYPE_RGBA_COLOR:
+                                fixed_size = 4;
+                                break;
+                            case OFXOSC_TYPE_INT64:
+                            case OFXOSC_TYPE_DOUBLE:
+                            case OFXOSC_TYPE_TIMETAG:
+                                fixed_size = 8;
+                                break;
+                            default:
+                                break;
+                        }
+                        if(remaining < fixed_size) break;
+                        bool supported = true;
+                        switch(type) {
+                            case OFXOSC_TYPE_INT32:
+                            case OFXOSC_TYPE_MIDI_MESSAGE:
+                            case OFXOSC_TYPE_RGBA_COLOR:
+                            case OFXOSC_TYPE_FLOAT:
+                                // same bits in little endian
+                                writer.write_u8(static_cast<std::uint8_t>(type));
+                                writer.write_u32(osc::read_be32(p));
+                                break;
+                            case OFXOSC_TYPE_CHAR:
+                                writer.write_u8(static_cast<std::uint8_t>(type));
+                                writer.write_u8(static_cast<std::uint8_t>(osc::read_be32(p)));
+                                break;
+                            case OFXOSC_TYPE_INT64:
+                            case OFXOSC_TYPE_DOUBLE:
+                            case OFXOSC_TYPE_TIMETAG:
+                                writer.write_u8(static_cast<std::uint8_t>(type));
+                                writer.write_u64(osc::read_be64(p));
+                                break;
+                            case OFXOSC_TYPE_STRING:
+                            case OFXOSC_TYPE_SYMBOL: {
+                                auto size = osc::padded_string_size(p, end);
+                                if(size == 0) {
+                                    supported = false;
+                                    break;
+                                }
+                                auto length = std::strlen(reinterpret_cast<const char *>(p));
+                                writer.write_u8(static_cast<std::uint8_t>(type));
+                                writer.write_u32(static_cast<std::uint32_t>(length));
+                                writer.write_bytes(p, length);
+                                fixed_size = size;
+                                break;
+                            }
+                            case OFXOSC_TYPE_BLOB: {
+                                if(remaining < 4) {
+                                    supported = false;
+                                    break;
+                                }
+                                std::size_t length = osc::read_be32(p);
+                                auto size = 4 + ((length + 3) & ~static_cast<std::size_t>(3));
+                                if(remaining < size) {
+                                    supported = false;
+                                    break;
+                                }
+                                writer.write_u8(static_cast<std::uint8_t>(type));
+                                writer.write_u32(static_cast<std::uint32_t>(length));
+                                writer.write_bytes(p + 4, length);
+                                fixed_size = size;
+                                break;
+                            }
+                            case OFXOSC_TYPE_TRUE:
+                            case OFXOSC_TYPE_FALSE:
+                            case OFXOSC_TYPE_NONE:
+                            case OFXOSC_TYPE_TRIGGER:
+                                writer.write_u8(static_cast<std::uint8_t>(type));
+                                break;
+                            default:
+                                supported = false;
+                                break;
+                        }
+                        if(!supported) break;
+                        p += fixed_size;
+                        ++num_args;
+                    }
+                    writer.buffer[num_position] = static_cast<std::uint8_t>(num_args);
+                    writer.buffer[num_position + 1] = static_cast<std::uint8_t>(num_args >> 8);
+                }
+
+                // appends size(u32) + record of OSC message on wire, without ofxOscMessageEx.
+                // e.g. for datagrams captured outside of Recorder
+                inline void write_record(std::vector<std::uint8_t> &buffer,
+                                         std::int64_t offset_ns,
+                                         const osc::message_view &message,
+                                         const std::string &host,
+                                         std::uint16_t port,
+                                         std::uint16_t received_port,
+                                         intern_cache &cache)
+                {
+                    binary_writer writer{buffer};
+                    auto size_position = writer.size();
+                    writer.write_u32(0);
+                    writer.write_i64(offset_ns);
+                    writer.write_u64(message.timetag);
+                    writer.write_varint(cache.address(message.address, message.address_length));
+                    writer.write_varint(cache.endpoint(host, port));
+                    writer.write_u16(received_port);
+                    write_osc_arguments(writer, message);
+                    writer.patch_u32(size_position,
+                                     static_cast<std::uint32_t>(writer.size() - size_position - 4));
+                }
+
+                // messages of packet (without size) are decoded into records of version 3 in scratch.
+                // callback: bool(std::int64_t offset_ns, binary_reader &record) returns false to stop
+                template <typename callback_t>
+                bool for_each_packet_record(const std::uint8_t *packet,
+                                            std::size_t size,
+                                            std::vector<std::uint8_t> &scratch,
+                                            callback_t &&callback)
+                {
+                    binary_reader reader{packet, size};
+                    packet_header header;
+                    if(!read_packet_header(reader, header)) return false;
+                    auto id_reader = reader;
+                    for(std::uint32_t i = 0; i < header.num_messages; ++i) reader.read_varint();
+                    if(!reader.good()) return false;
+                    auto length = reader.remaining();
+                    auto bytes = reader.read_bytes(length);
+                    bool stopped = false;
+                    std::uint32_t num_messages = 0;
+                    osc::for_each_message(bytes, length, [&](const osc::message_view &m) {
+                        if(stopped || header.num_messages <= num_messages) return;
+                        ++num_messages;
+                        scratch.clear();
+                        binary_writer writer{scratch};
+                        writer.write_i64(header.offset_ns);
+                        writer.write_u64(m.timetag);
+                        writer.write_varint(id_reader.read_varint());
+                        writer.write_varint(header.endpoint_id);
+                        writer.write_u16(header.received_port);
+                        write_osc_arguments(writer, m);
+                        binary_reader record{scratch.data(), scratch.size()};
+                        if(!callback(header.offset_ns, record)) stopped = true;
+                    });
+                    return true;
+                }
+
+                // packet (without size) as recorded
+                inline bool read_packet(const std::uint8_t *packet,
+                                        std::size_t size,
+                                        const dictionary &dict,
+                                        RawPacket &raw)
+                {
+                    binary_reader reader{packet, size};
+                    packet_header header;
+                    if(!read_packet_header(reader, header)) return false;
+                    for(std::uint32_t i = 0; i < header.num_messages; ++i) reader.read_varint();
+                    if(!reader.good() || dict.endpoints.size() <= header.endpoint_id) return false;
+                    raw.offset_ns = header.offset_ns;
+                    raw.host = dict.endpoints[header.endpoint_id].first;
+                    raw.port = dict.endpoints[header.endpoint_id].second;
+                    raw.received_port = header.received_port;
+                    auto length = reader.remaining();
+                    auto bytes = reader.read_bytes(length);
+                    raw.bytes.assign(bytes, bytes + length);
+                    return true;
+                }
+
+                // callback: void(const std::uint8_t *packet, std::size_t size) for each size(u32) + packet in payload of PKTS
+                template <typename callback_t>
+                void for_each_framed_packet(const std::uint8_t *payload,
+                                            std::size_t size,
+                                            callback_t &&callback)
+                {
+                    if(size < 4) return;
+                    binary_reader reader{payload + 4, size - 4};
+                    while(0 < reader.remaining()) {
+                        auto packet_size = reader.read_u32();
+                        auto packet = reader.read_bytes(packet_size);
+                        if(packet == nullptr) return;
+                        callback(packet, static_cast<std::size_t>(packet_size));
+                    }
+                }
+
+                inline std::vector<std::uint8_t> encode_metadata(const Metadata &metadata) {
+                    ofJson json = metadata;
+                    return ofJson::to_cbor(json);
+                }
+
+                inline bool decode_metadata(const std::uint8_t *data,
+                                            std::size_t size,
+                                            Metadata &metadata)
+                {
+                    try {
+                        metadata = ofJson::from_cbor(data, data + size);
+                        return true;
+                    } catch(const std::exception &e) {
+                        ofLogWarning("ofxRecordOsc") << "can't decode metadata: " << e.what();
+                        return false;
+                    }
+                }
+
+#pragma mark compression
+
+                constexpr std::uint8_t codec_none = 0;
+                constexpr std::uint8_t codec_lz4  = 1;
+                constexpr std::uint8_t codec_zstd = 2;
+                constexpr std::size_t compressed_header_size = 17;
+
+                inline std::uint64_t zigzag(std::int64_t value)
+                { return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63); };
+
+                inline std::int64_t unzigzag(std::uint64_t value)
+                { return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1); };
+
+                // previous values of arguments, indexed by address id and argument index
+                struct delta_state {
+                    std::int64_t offset{0};
+                    std::uint64_t timetag{0};
+                    std::vector<std::vector<std::uint64_t>> values;
+
+                    std::uint64_t &value(std::uint32_t address_id, std::size_t index) {
+                        if(values.size() <= address_id) values.resize(address_id + 1);
+                        auto &&args = values[address_id];
+                        if(args.size() <= index) args.resize(index + 1, 0);
+                        return args[index];
+                    }
+                };
+
+                // plain: payload of RECS chunk written by version 3 or later.
+                // returns false if record can't be encoded, then plain RECS should be written.
+                inline bool delta_encode(const std::uint8_t *plain,
+                                         std::size_t size,
+                                         std::vector<std::uint8_t> &encoded)
+                {
+                    delta_state state;
+                    binary_reader chunk_reader{plain, size};
+                    binary_writer writer{encoded};
+                    auto num_records = chunk_reader.read_u32();
+                    for(std::uint32_t i = 0; i < num_records && chunk_reader.good(); ++i) {
+                        auto record_size = chunk_reader.read_u32();
+                        auto record = chunk_reader.read_bytes(record_size);
+                        if(record == nullptr) return false;
+                        binary_reader reader{record, record_size};
+                        auto offset = reader.read_i64();
+                        auto timetag = reader.read_u64();
+                        writer.write_varint(zigzag(offset - state.offset));
+                        writer.write_varint(zigzag(static_cast<std::int64_t>(timetag - state.timetag)));
+                        state.offset = offset;
+                        state.timetag = timetag;
+                        auto address_id = static_cast<std::uint32_t>(reader.read_varint());
+                        writer.write_varint(address_id);
+                        writer.write_varint(reader.read_varint());
+                        writer.write_varint(reader.read_u16());
+                        auto num_args = reader.read_u16();
+                        writer.write_varint(num_args);
+                        for(std::size_t index = 0; index < num_args && reader.good(); ++index) {
+                            auto type = reader.read_u8();
+                            writer.write_u8(type);
+                            switch(static_cast<ofxOscArgType>(type)) {
+                                case OFXOSC_TYPE_INT32: {
+                                    auto &&previous = state.value(address_id, index);
+                                    std::int64_t value = reader.read_i32();
+                                    writer.write_varint(zigzag(value - static_cast<std::int32_t>(previous)));
+                                    previous = static_cast<std::uint64_t>(value);
+                                    break;
+                                }
+                                case OFXOSC_TYPE_INT64:
+                                case OFXOSC_TYPE_TIMETAG: {
+                                    auto &&previous = state.value(address_id, index);
+                                    auto value = reader.read_u64();
+                                    writer.write_varint(zigzag(static_cast<std::int64_t>(value - previous)));
+                                    previous = value;
+                                    break;
+                                }
+                                case OFXOSC_TYPE_FLOAT: {
+                                    auto &&previous = state.value(address_id, index);
+                                    std::uint64_t bits = reader.read_u32();
+                                    writer.write_varint(bits ^ previous);
+                                    previous = bits;
+                                    break;
+                                }
+                                case OFXOSC_TYPE_DOUBLE: {
+                                    auto &&previous = state.value(address_id, index);
+                                    auto bits = reader.read_u64();
+                                    writer.write_varint(bits ^ previous);
+                                    previous = bits;
+                                    break;
+                                }
+                                case OFXOSC_TYPE_CHAR:
+                                    writer.write_u8(reader.read_u8());
+                                    break;
+                                case OFXOSC_TYPE_MIDI_MESSAGE:
+                                case OFXOSC_TYPE_RGBA_COLOR:
+                                    writer.write_u32(reader.read_u32());
+                                    break;
+                                case OFXOSC_TYPE_STRING:
+                                case OFXOSC_TYPE_SYMBOL:
+                                case OFXOSC_TYPE_BLOB: {
+                                    auto length = reader.read_u32();
+                                    auto bytes = reader.read_bytes(length);
+                                    if(bytes == nullptr) return false;
+                                    writer.write_varint(length);
+                                    writer.write_bytes(bytes, length);
+                                    break;
+                                }
+                                case OFXOSC_TYPE_TRUE:
+                                case OFXOSC_TYPE_FALSE:
+                                case OFXOSC_TYPE_NONE:
+                                case OFXOSC_TYPE_TRIGGER:
+                                    break;
+                                default:
+                                    return false;
+                            }
+                        }
+                        if(!reader.good()) return false;
+                    }
+                    return chunk_reader.good();
+                }
+
+                // restores payload of RECS chunk
+                inline bool delta_decode(const std::uint8_t *encoded,
+                                         std::size_t size,
+                                         std::uint32_t num_records,
+                                         std::vector<std::uint8_t> &plain)
+                {
+                    delta_state state;
+                    binary_reader reader{encoded, size};
+                    binary_writer writer{plain};
+                    plain.reserve(size * 2);
+                    writer.write_u32(num_records);
+                    for(std::uint32_t i = 0; i < num_records && reader.good(); ++i) {
+                        auto size_position = writer.size();
+                        writer.write_u32(0);
+                        state.offset += unzigzag(reader.read_varint());
+                        state.timetag += static_cast<std::uint64_t>(unzigzag(reader.read_varint()));
+                        writer.write_i64(state.offset);
+                        writer.write_u64(state.timetag);
+                        auto address_id = static_cast<std::uint32_t>(reader.read_varint());
+                        writer.write_varint(address_id);
+                        writer.write_varint(reader.read_varint());
+                        writer.write_u16(static_cast<std::uint16_t>(reader.read_varint()));
+                        auto num_args = static_cast<std::uint16_t>(reader.read_varint());
+                        writer.write_u16(num_args);
+                        for(std::size_t index = 0; index < num_args && reader.good(); ++index) {
+                            auto type = reader.read_u8();
+                            writer.write_u8(type);
+                            switch(static_cast<ofxOscArgType>(type)) {
+                                case OFXOSC_TYPE_INT32: {
+                                    auto &&previous = state.value(address_id, index);
+                                    auto value = static_cast<std::int32_t>(static_cast<std::int32_t>(previous) + unzigzag(reader.read_varint()));
+                                    writer.write_i32(value);
+                                    previous = static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+                                    break;
+                                }
+                                case OFXOSC_TYPE_INT64:
+                                case OFXOSC_TYPE_TIMETAG: {
+                                    auto &&previous = state.value(address_id, index);
+                                    previous += static_cast<std::uint64_t>(unzigzag(reader.read_varint()));
+                                    writer.write_u64(previous);
+                                    break;
+                                }
+                                case OFXOSC_TYPE_FLOAT: {
+                                    auto &&previous = state.value(address_id, index);
+                                    previous ^= reader.read_varint();
+                                    writer.write_u32(static_cast<std::uint32_t>(previous));
+                                    break;
+                                }
+                                case OFXOSC_TYPE_DOUBLE: {
+                                    auto &&previous = state.value(address_id, index);
+                                    previous ^= reader.read_varint();
+                                    writer.write_u64(previous);
+                                    break;
+                                }
+                                case OFXOSC_TYPE_CHAR:
+                                    writer.write_u8(reader.read_u8());
+                                    break;
+                                case OFXOSC_TYPE_MIDI_MESSAGE:
+                                case OFXOSC_TYPE_RGBA_COLOR:
+                                    writer.write_u32(reader.read_u32());
+                                    break;
+                                case OFXOSC_TYPE_STRING:
+                                case OFXOSC_TYPE_SYMBOL:
+                                case OFXOSC_TYPE_BLOB: {
+                                    auto length = static_cast<std::uint32_t>(reader.read_varint());
+                                    auto bytes = reader.read_bytes(length);
+                                    if(bytes == nullptr) return false;
+                                    writer.write_u32(length);
+                                    writer.write_bytes(bytes, length);
+                                    break;
+                                }
+                                case OFXOSC_TYPE_TRUE:
+                                case OFXOSC_TYPE_FALSE:
+                                case OFXOSC_TYPE_NONE:
+                                case OFXOSC_TYPE_TRIGGER:
+                                    break;
+                                default:
+                                    return false;
+                            }
+                        }
+                        writer.patch_u32(size_position,
+                                         static_cast<std::uint32_t>(writer.size() - size_position - 4));
+                    }
+                    return reader.good();
+                }
+
+                inline bool is_codec_available(std::uint8_t codec) {
+                    switch(codec) {
+                        case codec_none: return true;
+#ifdef OFX_RECORD_OSC_USE_LZ4
+                        case codec_lz4: return true;
+#endif
+#ifdef OFX_RECORD_OSC_USE_ZSTD
+                        case codec_zstd: return true;
+#endif
+                        default: return false;
+                    }
+                }
+
+                // plain: payload of RECS chunk. compressed: payload of RECZ chunk
+                inline bool compress_records(const std::uint8_t *plain,
+                                             std::size_t size,
+                                             std::uint8_t codec,
+                                             std::vector<std::uint8_t> &delta,
+                                             std::vector<std::uint8_t> &compressed)
+                {
+                    // num_records(u32) size(u32) offset(i64) of first record
+                    if(size < 16 || !is_codec_available(codec)) return false;
+                    delta.clear();
+                    if(!delta_encode(plain, size, delta)) return false;
+                    binary_reader head{plain, 16};
+                    auto num_records = head.read_u32();
+                    head.read_u32();
+                    auto first_offset = head.read_i64();
+
+                    compressed.clear();
+                    binary_writer writer{compressed};
+                    writer.write_u32(num_records);
+                    writer.write_i64(first_offset);
+                    writer.write_u8(codec);
+                    writer.write_u32(static_cast<std::uint32_t>(delta.size()));
+                    switch(codec) {
+#ifdef OFX_RECORD_OSC_USE_LZ4
+                        case codec_lz4: {
+                            auto bound = LZ4_compressBound(static_cast<int>(delta.size()));
+                            compressed.resize(compressed_header_size + bound);
+                            auto result = LZ4_compress_default(reinterpret_cast<const char *>(delta.data()),
+                                                               reinterpret_cast<char *>(compressed.data() + compressed_header_size),
+                                                               static_cast<int>(delta.size()),
+                                                               bound);
+                            if(result <= 0) return false;
+                            compressed.resize(compressed_header_size + result);
+                            return true;
+                        }
+#endif
+#ifdef OFX_RECORD_OSC_USE_ZSTD
+                        case codec_zstd: {
+                            auto bound = ZSTD_compressBound(delta.size());
+                            compressed.resize(compressed_header_size + bound);
+                            auto result = ZSTD_compress(compressed.data() + compressed_header_size,
+                                                        bound,
+                                                        delta.data(),
+                                                        delta.size(),
+                                                        1);
+                            if(ZSTD_isError(result)) return false;
+                            compressed.resize(compressed_header_size + result);
+                            return true;
+                        }
+#endif
+                        default:
+                            writer.write_bytes(delta.data(), delta.size());
+                            return true;
+                    }
+                }
+
+                // restores payload of RECS chunk from payload of RECZ chunk
+                // delta is scratch buffer of decompression
+                inline bool decompress_records(const std::uint8_t *compressed,
+                                               std::size_t size,
+                                               std::vector<std::uint8_t> &plain,
+                                               std::vector<std::uint8_t> &delta)
+                {
+                    binary_reader reader{compressed, size};
+                    auto num_records = reader.read_u32();
+                    reader.read_i64();
+                    auto codec = reader.read_u8();
+                    std::size_t delta_size = reader.read_u32();
+                    if(!reader.good()) return false;
+                    const auto body = compressed + compressed_header_size;
+                    const auto body_size = size - compressed_header_size;
+                    plain.clear();
+                    if(codec == codec_none) {
+                        return delta_decode(body, body_size, num_records, plain);
+                    }
+                    delta.resize(delta_size);
+                    switch(codec) {
+#ifdef OFX_RECORD_OSC_USE_LZ4
+                        case codec_lz4: {
+                            auto result = LZ4_decompress_safe(reinterpret_cast<const char *>(body),
+                                                              reinterpret_cast<char *>(delta.data()),
+                                                              static_cast<int>(body_size),
+                                                              static_cast<int>(delta_size));
+                            if(result != static_cast<int>(delta_size)) return false;
+                            break;
+                        }
+#endif
+#ifdef OFX_RECORD_OSC_USE_ZSTD
+                        case codec_zstd: {
+                            auto result = ZSTD_decompress(delta.data(), delta_size, body, body_size);
+                            if(ZSTD_isError(result) || result != delta_size) return false;
+                            break;
+                        }
+#endif
+                        default:
+                            ofLogWarning("ofxRecordOsc") << "codec " << (int)codec << " is not available. define OFX_RECORD_OSC_USE_LZ4 or OFX_RECORD_OSC_USE_ZSTD.";
+                            return false;
+                    }
+                    return delta_decode(delta.data(), delta.size(), num_records, plain);
+                }
+
+                inline bool decompress_records(const std::uint8_t *compressed,
+                                               std::size_t size,
+                                               std::vector<std::uint8_t> &plain)
+                {
+                    std::vector<std::uint8_t> delta;
+                    return decompress_records(compressed, size, plain, delta);
+                }
+            }; // namespace native
+        }; // namespace detail
+
+        // compression of records in Native format
+        enum class Compression : std::uint8_t {
+            None,  // RECS chunk
+            Delta, // RECZ chunk. delta / xor / varint encoding
+            LZ4,   // Delta + LZ4. needs OFX_RECORD_OSC_USE_LZ4 and liblz4
+            Zstd   // Delta + Zstd. needs OFX_RECORD_OSC_USE_ZSTD and libzstd
+        };
+
+        struct NativeWriter {
+            ~NativeWriter()
+            { if(isOpen()) close(); };
+
+            bool open(const std::string &filepath,
+                      const Metadata &metadata)
+            {
+                if(isOpen()) close();
+                table.reset();
+                return openFile(filepath, metadata);
+            }
+
+            // closes current file as finalized segment and continues on new file.
+            // ids of interned addresses are kept, so records encoded before rotation are still valid.
+            bool rotate(const std::string &filepath,
+                        const Metadata &closing_metadata,
+                        const Metadata &opening_metadata)
+            {
+                auto success = close(closing_metadata);
+                if(!openFile(filepath, opening_metadata)) return false;
+                if(table.snapshot(dictionary_payload)) {
+                    success = writeChunk(detail::native::tag_dictionary, dictionary_payload.data(), dictionary_payload.size()) && success;
+                }
+                return success;
+            }
+
+            // framed_records must be a sequence of size(u32) + record
+            // (e.g. made by detail::native::write_record)
+            void append(const std::uint8_t *framed_records,
+                        std::size_t size,
+                        std::size_t num_framed_records)
+            {
+                switchBlock(false);
+                appendFramed(framed_records, size, num_framed_records);
+            }
+
+            void append(std::int64_t offset_ns,
+                        std::uint64_t timetag,
+                        const ofxOscMessageEx &mess)
+            {
+                switchBlock(false);
+                detail::native::write_record(block, offset_ns, timetag, mess, cache);
+                updateOffsets(offset_ns);
+                ++block_records;
+                ++num_records;
+                if(isBlockFull()) flush();
+            }
+
+            void append(const SequenceData &data)
+            { append(data.offset_ns, data.timetag, data.mess); };
+
+            // framed_packets must be a sequence of size(u32) + packet made by detail::native::write_packet.
+            // packets are written to PKTS chunks as is, num_messages is total of messages in packets.
+            void appendPackets(const std::uint8_t *framed_packets,
+                               std::size_t size,
+                               std::size_t num_messages)
+            {
+                switchBlock(true);
+                appendFramed(framed_packets, size, num_messages);
+            }
+
+            void append(const RawPacket &packet) {
+                switchBlock(true);
+                auto num_messages = detail::native::write_packet(block, packet, cache);
+                updateOffsets(packet.offset_ns);
+                block_records += num_messages;
+                num_records += num_messages;
+                if(isBlockFull()) flush();
+            }
+
+            bool flush() {
+                if(!isOpen()) return false;
+                // packets without message (e.g. broken) are also written
+                if(block.size() <= 4) return true;
+                // dictionary entries are written before records refer them
+                auto success = true;
+                if(table.take(dictionary_payload)) {
+                    success = writeChunk(detail::native::tag_dictionary, dictionary_payload.data(), dictionary_payload.size());
+                }
+                detail::native::binary_writer writer{block};
+                writer.patch_u32(0, static_cast<std::uint32_t>(block_records));
+                auto tag = block_has_packets ? detail::native::tag_packets : detail::native::tag_records;
+                const std::vector<std::uint8_t> *payload = &block;
+                if(!block_has_packets
+                   && compression != Compression::None
+                   && detail::native::compress_records(block.data(), block.size(), codec(), delta_buffer, compressed_block))
+                {
+                    tag = detail::native::tag_compressed_records;
+                    payload = &compressed_block;
+                }
+                index.push_back({position, static_cast<std::uint32_t>(payload->size()), static_cast<std::uint32_t>(block_records), block_min_offset_ns, block_max_offset_ns});
+                success = writeChunk(tag, payload->data(), payload->size()) && success;
+                resetBlock();
+                std::fflush(fp);
+                return success;
+            }
+
+            bool close(const Metadata &metadata) {
+                if(!isOpen()) return false;
+                auto success = flush();
+
+                // all entries of dictionary and index are written at the end for fast open
+                std::uint64_t dictionary_position = 0;
+                if(table.snapshot(dictionary_payload)) {
+                    dictionary_position = position;
+                    success = writeChunk(detail::native::tag_dictionary, dictionary_payload.data(), dictionary_payload.size()) && success;
+                }
+                std::uint64_t index_position = position;
+                std::vector<std::uint8_t> index_payload;
+                detail::native::binary_writer index_writer{index_payload};
+                index_writer.write_i64(index_interval_ns);
+                index_writer.write_u32(static_cast<std::uint32_t>(index.size()));
+                for(const auto &entry : index) {
+                    index_writer.write_u64(entry.position);
+                    index_writer.write_u32(entry.size);
+                    index_writer.write_u32(entry.num_records);
+                    index_writer.write_i64(entry.min_offset_ns);
+                    index_writer.write_i64(entry.max_offset_ns);
+                }
+                success = writeChunk(detail::native::tag_index, index_payload.data(), index_payload.size()) && success;
+
+                std::uint64_t trailer_position = position;
+                std::vector<std::uint8_t> trailer;
+                detail::native::binary_writer writer{trailer};
+                writer.write_u64(num_records);
+                writer.write_u64(index_position);
+                writer.write_u64(dictionary_position);
+                auto &&meta = detail::native::encode_metadata(metadata);
+                writer.write_bytes(meta.data(), meta.size());
+                success = writeChunk(detail::native::tag_trailer, trailer.data(), trailer.size()) && success;
+
+                std::vector<std::uint8_t> footer;
+                detail::native::binary_writer footer_writer{footer};
+                footer_writer.write_u64(trailer_position);
+                footer_writer.write_bytes(detail::native::footer_magic, sizeof(detail::native::footer_magic));
+                success = write(footer.data(), footer.size()) && success;
+
+                return closeFile() && success;
+            }
+
+            bool close() {
+                if(!isOpen()) return false;
+                auto success = flush();
+                return closeFile() && success;
+            }
+
+            bool isOpen() const
+            { return fp != nullptr; };
+
+            // applied from next chunk. LZ4 / Zstd falls back to Delta if not available
+            void setCompression(Compression compression) {
+                if(!detail::native::is_codec_available(codecOf(compression))) {
+                    ofLogWarning("ofxRecordOsc") << "compression " << (int)compression << " is not available. Delta is used. define OFX_RECORD_OSC_USE_LZ4 or OFX_RECORD_OSC_USE_ZSTD and link the library.";
+                    compression = Compression::Delta;
+                }
+                this->compression = compression;
+            }
+
+            Compression getCompression() const
+            { return compression; };
+
+            std::uint64_t numRecords() const
+            { return num_records; };
+
+            // written bytes including buffered records
+            std::uint64_t numBytes() const
+            { return position + block.size(); };
+
+            // offsets of records appended to current file
+            std::int64_t firstOffsetNanos() const
+            { return first_offset_ns; };
+
+            std::int64_t lastOffsetNanos() const
+            { return last_offset_ns; };
+
+            const std::string &filepath() const
+            { return path; };
+
+            // records made by other threads must be encoded with intern_cache of this table
+            detail::native::intern_table &internTable()
+            { return table; };
+
+            std::size_t block_size{64 * 1024};
+            // RECS chunk is closed when it spans this duration, so each entry of seek index
+            // covers at most block_size bytes or this duration.
+            std::int64_t index_interval_ns{1000 * 1000 * 1000};
+        private:
+            struct index_entry {
+                std::uint64_t position;
+                std::uint32_t size;
+                std::uint32_t num_records;
+                std::int64_t min_offset_ns;
+                std::int64_t max_offset_ns;
+            };
+            std::vector<index_entry> index;
+            Compression compression{Compression::None};
+            std::vector<std::uint8_t> delta_buffer;
+            std::vector<std::uint8_t> compressed_block;
+
+            static std::uint8_t codecOf(Compression compression) {
+                switch(compression) {
+                    case Compression::LZ4: return detail::native::codec_lz4;
+                    case Compression::Zstd: return detail::native::codec_zstd;
+                    default: return detail::native::codec_none;
+                }
+            }
+
+            std::uint8_t codec() const
+            { return codecOf(compression); };
+            std::int64_t block_min_offset_ns{0};
+            std::int64_t block_max_offset_ns{0};
+            bool block_has_offset{false};
+            bool block_has_packets{false}; // block is PKTS chunk
+
+            detail::native::intern_table table;
+            detail::native::intern_cache cache{table};
+            std::vector<std::uint8_t> dictionary_payload;
+            std::FILE *fp{nullptr};
+            std::string path;
+            std::uint64_t position{0};
+            std::uint64_t num_records{0};
+            std::vector<std::uint8_t> block;
+            std::size_t block_records{0};
+            std::int64_t first_offset_ns{0};
+            std::int64_t last_offset_ns{0};
+            bool has_offset{false};
+
+            bool openFile(const std::string &filepath,
+                          const Metadata &metadata)
+            {
+                fp = std::fopen(filepath.c_str(), "wb");
+                if(fp == nullptr) {
+                    ofLogError("ofxRecordOsc") << "can't open file: " << filepath << " on save";
+                    return false;
+                }
+                path = filepath;
+                position = 0;
+                num_records = 0;
+                first_offset_ns = last_offset_ns = 0;
+                has_offset = false;
+                index.clear();
+                resetBlock();
+
+                std::vector<std::uint8_t> header;
+                detail::native::binary_writer writer{header};
+                writer.write_bytes(detail::native::header_magic, sizeof(detail::native::header_magic));
+                writer.write_u32(detail::native::version);
+                auto &&meta = detail::native::encode_metadata(metadata);
+                return write(header.data(), header.size())
+                    && writeChunk(detail::native::tag_metadata, meta.data(), meta.size());
+            }
+
+            // records and packets are written to separated chunks,
+            // so chunk is closed when kind of appended data is changed.
+            void switchBlock(bool packets) {
+                if(block_has_packets == packets) return;
+                flush();
+                block_has_packets = packets;
+            }
+
+            void appendFramed(const std::uint8_t *framed,
+                              std::size_t size,
+                              std::size_t num_framed_records)
+            {
+                block.insert(block.end(), framed, framed + size);
+                // offset(i64) is head of each record / packet
+                for(std::size_t p = 0; p + 12 <= size;) {
+                    detail::native::binary_reader reader{framed + p, size - p};
+                    auto record_size = reader.read_u32();
+                    updateOffsets(reader.read_i64());
+                    p += 4 + record_size;
+                }
+                block_records += num_framed_records;
+                num_records += num_framed_records;
+                if(isBlockFull()) flush();
+            }
+
+            void updateOffsets(std::int64_t offset_ns) {
+                if(!has_offset) first_offset_ns = offset_ns;
+                last_offset_ns = offset_ns;
+                has_offset = true;
+                if(!block_has_offset || offset_ns < block_min_offset_ns) block_min_offset_ns = offset_ns;
+                if(!block_has_offset || block_max_offset_ns < offset_ns) block_max_offset_ns = offset_ns;
+                block_has_offset = true;
+            }
+
+            bool isBlockFull() const {
+                return block_size <= block.size()
+                    || (0 < index_interval_ns && index_interval_ns <= block_max_offset_ns - block_min_offset_ns);
+            }
+
+            void resetBlock() {
+                block.clear();
+                block.reserve(block_size + 1024);
+                block.resize(4); // placeholder of num_records
+                block_records = 0;
+                block_min_offset_ns = block_max_offset_ns = 0;
+                block_has_offset = false;
+            }
+
+            bool write(const std::uint8_t *data, std::size_t size) {
+                auto wrote = std::fwrite(data, sizeof(std::uint8_t), size, fp);
+                position += wrote;
+                if(wrote == size) return true;
+                ofLogWarning("ofxRecordOsc") << "written size is incorrect. written: " << wrote << ", data-size: " << size;
+                return false;
+            }
+
+            bool writeChunk(std::uint32_t tag,
+                            const std::uint8_t *payload,
+                            std::size_t size)
+            {
+                std::uint8_t chunk_header[detail::native::chunk_header_size];
+                for(std::size_t i = 0; i < 4; ++i) {
+                    chunk_header[i] = static_cast<std::uint8_t>(tag >> (8 * i));
+                    chunk_header[i + 4] = static_cast<std::uint8_t>(size >> (8 * i));
+                }
+                return write(chunk_header, sizeof(chunk_header))
+                    && write(payload, size);
+            }
+
+            bool closeFile() {
+                auto success = std::fclose(fp) == 0;
+                fp = nullptr;
+                return success;
+            }
+        }; // struct NativeWriter
+
+        struct NativeReader {
+            // callback: void(const SequenceData &)
+            // messages in raw packets are also passed.
+            template <typename callback_t>
+            bool read(const std::string &filepath,
+                      callback_t callback)
+            { return read(filepath, callback, [](const RawPacket &) {}); };
+
+            // packet_callback: void(const RawPacket &) for each packet recorded by Recorder::listenRaw
+            template <typename callback_t, typename packet_callback_t>
+            bool read(const std::string &filepath,
+                      callback_t callback,
+                      packet_callback_t packet_callback)
+            {
+                std::FILE *fp = std::fopen(filepath.c_str(), "rb");
+                if(fp == nullptr) {
+                    ofLogError("ofxRecordOsc") << "can't open file: " << filepath << " on load.";
+                    return false;
+                }
+                auto &&result = readFile(fp, filepath, callback, packet_callback);
+                std::fclose(fp);
+                return result;
+            }
+
+            bool read(const std::string &filepath,
+                      std::vector<SequenceData> &sequence)
+            {
+                return read(filepath, [&sequence](const SequenceData &data) {
+                    sequence.push_back(data);
+                });
+            }
+
+            bool read(const std::string &filepath,
+                      std::vector<SequenceData> &sequence,
+                      std::vector<RawPacket> &packets)
+            {
+                return read(filepath,
+                            [&sequence](const SequenceData &data) { sequence.push_back(data); },
+                            [&packets](const RawPacket &packet) { packets.push_back(packet); });
+            }
+
+            const Metadata &metadata() const
+            { return meta; };
+
+            std::uint64_t numRecords() const
+            { return num_records; };
+
+            // false if file has no trailer (e.g. recorder was crashed)
+            bool isFinalized() const
+            { return finalized; };
+
+            // empty if file is written by version 2 or older
+            const detail::native::dictionary &dictionary() const
+            { return dict; };
+
+            std::uint32_t fileVersion() const
+            { return file_version; };
+
+        private:
+            Metadata meta;
+            detail::native::dictionary dict;
+            std::uint32_t file_version{detail::native::version};
+            std::uint64_t num_records{0};
+            bool finalized{false};
+
+            template <typename callback_t, typename packet_callback_t>
+            bool readFile(std::FILE *fp,
+                          const std::string &filepath,
+                          callback_t &callback,
+                          packet_callback_t &packet_callback)
+            {
+                num_records = 0;
+                finalized = false;
+                dict.clear();
+
+                std::uint8_t header[detail::native::header_size];
+                if(std::fread(header, 1, sizeof(header), fp) != sizeof(header)
+                   || std::memcmp(header, detail::native::header_magic, sizeof(detail::native::header_magic)) != 0)
+                {
+                    ofLogError("ofxRecordOsc") << filepath << " is not ofxRecordOsc native file.";
+                    return false;
+                }
+                detail::native::binary_reader header_reader{header + sizeof(detail::native::header_magic), 4};
+                file_version = header_reader.read_u32();
+                if(detail::native::version < file_version) {
+                    ofLogError("ofxRecordOsc") << filepath << " is written by newer version: " << file_version;
+                    return false;
+                }
+
+                std::vector<std::uint8_t> payload, plain, scratch;
+                SequenceData data;
+                RawPacket packet;
+                while(true) {
+                    std::uint8_t chunk_header[detail::native::chunk_header_size];
+                    if(std::fread(chunk_header, 1, sizeof(chunk_header), fp) != sizeof(chunk_header)) break;
+                    detail::native::binary_reader chunk_reader{chunk_header, sizeof(chunk_header)};
+                    auto tag = chunk_reader.read_u32();
+                    auto size = chunk_reader.read_u32();
+                    payload.resize(size);
+                    if(std::fread(payload.data(), 1, size, fp) != size) {
+                        ofLogWarning("ofxRecordOsc") << filepath << " is truncated.";
+                        break;
+                    }
+
+                    if(tag == detail::native::tag_metadata) {
+                        detail::native::decode_metadata(payload.data(), payload.size(), meta);
+                    } else if(tag == detail::native::tag_dictionary) {
+                        dict.read(payload.data(), payload.size());
+                    } else if(tag == detail::native::tag_records || tag == detail::native::tag_compressed_records) {
+                        if(tag == detail::native::tag_compressed_records) {
+                            if(!detail::native::decompress_records(payload.data(), payload.size(), plain)) {
+                                ofLogWarning("ofxRecordOsc") << "broken chunk is skipped.";
+                                continue;
+                            }
+                            payload.swap(plain);
+                        }
+                        detail::native::binary_reader reader{payload.data(), payload.size()};
+                        auto count = reader.read_u32();
+                        for(std::size_t i = 0; i < count && reader.good(); ++i) {
+                            auto record_size = reader.read_u32();
+                            auto record = reader.read_bytes(record_size);
+                            if(record == nullptr) break;
+                            detail::native::binary_reader record_reader{record, record_size};
+                            if(!detail::native::read_record(record_reader, data, file_version, dict)) {
+                                ofLogWarning("ofxRecordOsc") << "broken record is skipped.";
+                                continue;
+                            }
+                            data.sequence = num_records;
+                            callback(static_cast<const SequenceData &>(data));
+                            ++num_records;
+                        }
+                    } else if(tag == detail::native::tag_packets) {
+                        detail::native::for_each_framed_packet(payload.data(), payload.size(), [&](const std::uint8_t *p, std::size_t size) {
+                            if(!detail::native::read_packet(p, size, dict, packet)) {
+                                ofLogWarning("ofxRecordOsc") << "broken packet is skipped.";
+                                return;
+                            }
+                            packet_callback(static_cast<const RawPacket &>(packet));
+                            detail::native::for_each_packet_record(p, size, scratch, [&](std::int64_t, detail::native::binary_reader &record_reader) {
+                                if(!detail::native::read_record(record_reader, data, file_version, dict)) {
+                                    ofLogWarning("ofxRecordOsc") << "broken record is skipped.";
+                                    return true;
+                                }
+                                data.sequence = num_records;
+                                callback(static_cast<const SequenceData &>(data));
+                                ++num_records;
+                                return true;
+                            });
+                        });
+                    } else if(tag == detail::native::tag_trailer) {
+                        detail::native::binary_reader reader{payload.data(), payload.size()};
+                        detail::native::read_trailer_positions(reader, file_version);
+                        detail::native::decode_metadata(payload.data() + reader.position(),
+                                                        reader.remaining(),
+                                                        meta);
+                        finalized = true;
+                        break;
+                    } else {
+                        // unknown chunk is skipped for forward compatibility
+                    }
+                }
+                if(!finalized) {
+                    ofLogWarning("ofxRecordOsc") << filepath << " has no trailer. recording may not be finished correctly.";
+                }
+                return true;
+            }
+        }; // struct NativeReader
+
+        // maps native file and indexes only RECS / RECZ / PKTS chunks.
+        // records are decoded on demand.
+        struct NativeMappedReader {
+            struct chunk_entry {
+                std::int64_t first_offset_ns;
+                std::size_t head;           // position of RECS or RECZ chunk in file
+                std::size_t end;            // end of chunk payload
+                std::uint32_t num_records;
+                std::uint64_t first_index;  // sequence of first record
+                // only with seek index (indexed() is true)
+                std::int64_t min_offset_ns{0};
+                std::int64_t max_offset_ns{0};
+                std::int64_t max_offset_until_ns{0}; // max of max_offset_ns in chunks[0, i]
+                std::int64_t min_offset_after_ns{0}; // min of min_offset_ns in chunks[i, end)
+            };
+
+            bool open(const std::string &filepath) {
+                chunks.clear();
+                dict.clear();
+                plain_cache.reset();
+                num_records = 0;
+                finalized = false;
+                sorted = true;
+                indexed = false;
+                if(!file.open(filepath)) return false;
+
+                const auto data = file.data();
+                const auto size = file.size();
+                if(size < detail::native::header_size
+                   || std::memcmp(data, detail::native::header_magic, sizeof(detail::native::header_magic)) != 0)
+                {
+                    ofLogError("ofxRecordOsc") << filepath << " is not ofxRecordOsc native file.";
+                    file.close();
+                    return false;
+                }
+                detail::native::binary_reader header_reader{data + sizeof(detail::native::header_magic), 4};
+                file_version = header_reader.read_u32();
+                if(detail::native::version < file_version) {
+                    ofLogError("ofxRecordOsc") << filepath << " is written by newer version: " << file_version;
+                    file.close();
+                    return false;
+                }
+
+                if(4 <= file_version && openIndexed()) return true;
+                // broken or not finalized, chunks are scanned
+                chunks.clear();
+                dict.clear();
+                num_records = 0;
+                sorted = true;
+
+                std::size_t pos = detail::native::header_size;
+                while(detail::native::chunk_header_size <= size - pos) {
+                    detail::native::binary_reader chunk_reader{data + pos, detail::native::chunk_header_size};
+                    auto tag = chunk_reader.read_u32();
+                    std::size_t chunk_size = chunk_reader.read_u32();
+                    auto payload = pos + detail::native::chunk_header_size;
+                    if(size - payload < chunk_size) {
+                        ofLogWarning("ofxRecordOsc") << filepath << " is truncated.";
+                        break;
+                    }
+                    if(tag == detail::native::tag_metadata) {
+                        detail::native::decode_metadata(data + payload, chunk_size, meta);
+                    } else if(tag == detail::native::tag_dictionary) {
+                        dict.read(data + payload, chunk_size);
+                    } else if((tag == detail::native::tag_records
+                               || tag == detail::native::tag_compressed_records
+                               || tag == detail::native::tag_packets)
+                              && 8 <= chunk_size)
+                    {
+                        // RECS, PKTS: count(u32) size(u32) offset(i64 or f64) of first record / packet
+                        // RECZ: count(u32) offset(i64) of first record
+                        detail::native::binary_reader reader{data + payload, chunk_size};
+                        chunk_entry entry;
+                        entry.num_records = reader.read_u32();
+                        entry.head = pos;
+                        entry.end = payload + chunk_size;
+                        entry.first_index = num_records;
+                        if(tag == detail::native::tag_compressed_records) {
+                            entry.first_offset_ns = reader.read_i64();
+                        } else {
+                            reader.read_u32();
+                            entry.first_offset_ns = readOffset(reader);
+                        }
+                        if(!reader.good()) break;
+                        if(!chunks.empty() && entry.first_offset_ns < chunks.back().first_offset_ns) sorted = false;
+                        chunks.push_back(entry);
+                        num_records += entry.num_records;
+                    } else if(tag == detail::native::tag_trailer) {
+                        detail::native::binary_reader reader{data + payload, chunk_size};
+                        detail::native::read_trailer_positions(reader, file_version);
+                        detail::native::decode_metadata(data + payload + reader.position(),
+                                                        reader.remaining(),
+                                                        meta);
+                        finalized = true;
+                        break;
+                    }
+                    pos = payload + chunk_size;
+                }
+
+                first_offset_ns = last_offset_ns = 0;
+                if(!chunks.empty()) {
+                    first_offset_ns = chunks.front().first_offset_ns;
+                    last_offset_ns = first_offset_ns;
+                    walkChunk(chunks.back(), [this](std::int64_t offset_ns, detail::native::binary_reader &) {
+                        last_offset_ns = (std::max)(last_offset_ns, offset_ns);
+                        return true;
+                    });
+                }
+                return true;
+            }
+
+            void close()
+            { file.close(); };
+
+            // callback: void(const SequenceData &)
+            template <typename callback_t>
+            void forEachRecord(callback_t callback) const {
+                SequenceData data;
+                for(const auto &chunk : chunks) {
+                    auto index = chunk.first_index;
+                    walkChunk(chunk, [&](std::int64_t, detail::native::binary_reader &record_reader) {
+                        if(decode(record_reader, data, index++)) callback(static_cast<const SequenceData &>(data));
+                        return true;
+                    });
+                }
+            }
+
+            // records are passed in order of file.
+            // callback: void(const SequenceData &)
+            template <typename callback_t>
+            void forEachRecordInRange(std::int64_t from_ns,
+                                      std::int64_t to_ns,
+                                      callback_t callback) const
+            { forEachRecordInRange(from_ns, to_ns, callback, [](std::uint32_t) { return true; }); };
+
+            // records whose address id is not accepted are skipped without decoding.
+            // accept_address: bool(std::uint32_t address_id). not used for file of version 2 or older
+            template <typename callback_t, typename accept_address_t>
+            void forEachRecordInRange(std::int64_t from_ns,
+                                      std::int64_t to_ns,
+                                      callback_t callback,
+                                      accept_address_t accept_address) const
+            {
+                if(chunks.empty() || to_ns < from_ns) return;
+                SequenceData data;
+                if(indexed) {
+                    // chunks which can include records in range are found exactly
+                    auto it = std::lower_bound(chunks.begin(),
+                                               chunks.end(),
+                                               from_ns,
+                                               [](const chunk_entry &c, std::int64_t t) { return c.max_offset_until_ns < t; });
+                    for(; it != chunks.end() && it->min_offset_after_ns <= to_ns; ++it) {
+                        const auto &chunk = *it;
+                        if(chunk.max_offset_ns < from_ns || to_ns < chunk.min_offset_ns) continue;
+                        auto index = chunk.first_index;
+                        walkChunk(chunk, [&](std::int64_t offset_ns, detail::native::binary_reader &record_reader) {
+                            auto sequence = index++;
+                            if(offset_ns < from_ns || to_ns < offset_ns) return true;
+                            if(3 <= file_version && !accept_address(peekAddressId(record_reader))) return true;
+                            if(decode(record_reader, data, sequence)) callback(static_cast<const SequenceData &>(data));
+                            return true;
+                        });
+                    }
+                    return;
+                }
+                auto it = std::upper_bound(chunks.begin(),
+                                           chunks.end(),
+                                           from_ns,
+                                           [](std::int64_t t, const chunk_entry &c) { return t < c.first_offset_ns; });
+                // offsets between chunks can be slightly inverted by concurrent receivers,
+                // so one more chunk is checked on both side.
+                auto begin = std::distance(chunks.begin(), it);
+                begin = (std::max)(begin - 2, static_cast<decltype(begin)>(0));
+                bool over = false;
+                for(auto i = static_cast<std::size_t>(begin); i < chunks.size(); ++i) {
+                    const auto &chunk = chunks[i];
+                    if(to_ns < chunk.first_offset_ns) {
+                        if(over) break;
+                        over = true;
+                    }
+                    auto index = chunk.first_index;
+                    walkChunk(chunk, [&](std::int64_t offset_ns, detail::native::binary_reader &record_reader) {
+                        auto sequence = index++;
+                        if(offset_ns < from_ns || to_ns < offset_ns) return true;
+                        if(3 <= file_version && !accept_address(peekAddressId(record_reader))) return true;
+                        if(decode(record_reader, data, sequence)) callback(static_cast<const SequenceData &>(data));
+                        return true;
+                    });
+                }
+            }
+
+            // packets recorded by Recorder::listenRaw in range, in order of file.
+            // callback: void(const RawPacket &)
+            template <typename callback_t>
+            void forEachPacketInRange(std::int64_t from_ns,
+                                      std::int64_t to_ns,
+                                      callback_t callback) const
+            {
+                if(to_ns < from_ns) return;
+                RawPacket packet;
+                for(const auto &chunk : chunks) {
+                    if(indexed && (chunk.max_offset_ns < from_ns || to_ns < chunk.min_offset_ns)) continue;
+                    detail::native::binary_reader chunk_reader{file.data() + chunk.head, detail::native::chunk_header_size};
+                    if(chunk_reader.read_u32() != detail::native::tag_packets) continue;
+                    const auto payload = file.data() + chunk.head + detail::native::chunk_header_size;
+                    detail::native::for_each_framed_packet(payload, chunk.end - (chunk.head + detail::native::chunk_header_size), [&](const std::uint8_t *p, std::size_t size) {
+                        // offset(i64) is head of packet
+                        detail::native::binary_reader offset_reader{p, size};
+                        auto offset_ns = offset_reader.read_i64();
+                        if(offset_ns < from_ns || to_ns < offset_ns) return;
+                        if(detail::native::read_packet(p, size, dict, packet)) callback(static_cast<const RawPacket &>(packet));
+                    });
+                }
+            }
+
+            // decodes records of i-th chunk into out[0, chunkAt(i).num_records).
+            // packets of PKTS chunk are appended to packets.
+            // returns number of decoded records, less than num_records if broken records are skipped.
+            // different chunks can be decoded concurrently.
+            std::size_t decodeChunk(std::size_t i,
+                                    SequenceData *out,
+                                    std::vector<RawPacket> &packets) const
+            {
+                const auto &chunk = chunks[i];
+                std::size_t num_decoded = 0;
+                auto index = chunk.first_index;
+                walkChunk(chunk, [&](std::int64_t, detail::native::binary_reader &record_reader) {
+                    if(chunk.num_records <= num_decoded) return false;
+                    if(decode(record_reader, out[num_decoded], index++)) ++num_decoded;
+                    return true;
+                });
+                decodePackets(i, packets);
+                return num_decoded;
+            }
+
+            // true if i-th chunk is PKTS chunk (recorded by Recorder::listenRaw)
+            bool isPacketChunk(std::size_t i) const {
+                detail::native::binary_reader chunk_reader{file.data() + chunks[i].head, detail::native::chunk_header_size};
+                return chunk_reader.read_u32() == detail::native::tag_packets;
+            }
+
+            // appends packets of i-th chunk to packets, nothing if it is not PKTS chunk
+            void decodePackets(std::size_t i,
+                               std::vector<RawPacket> &packets) const
+            {
+                if(!isPacketChunk(i)) return;
+                const auto &chunk = chunks[i];
+                const auto payload = file.data() + chunk.head + detail::native::chunk_header_size;
+                RawPacket packet;
+                detail::native::for_each_framed_packet(payload, chunk.end - (chunk.head + detail::native::chunk_header_size), [&](const std::uint8_t *p, std::size_t size) {
+                    if(detail::native::read_packet(p, size, dict, packet)) packets.push_back(packet);
+                });
+            }
+
+            const Metadata &metadata() const
+            { return meta; };
+
+            std::uint64_t numRecords() const
+            { return num_records; };
+
+            std::size_t numChunks() const
+            { return chunks.size(); };
+
+            const chunk_entry &chunkAt(std::size_t i) const
+            { return chunks[i]; };
+
+            // min / max of offsets in i-th chunk. records are walked if file has no seek index.
+            // returns false if chunk has no record
+            bool chunkOffsetRange(std::size_t i,
+                                  std::int64_t &min_offset_ns,
+                                  std::int64_t &max_offset_ns) const
+            {
+                const auto &chunk = chunks[i];
+                if(indexed) {
+                    min_offset_ns = chunk.min_offset_ns;
+                    max_offset_ns = chunk.max_offset_ns;
+                    return 0 < chunk.num_records;
+                }
+                bool found = false;
+                walkChunk(chunk, [&](std::int64_t offset_ns, detail::native::binary_reader &) {
+                    if(!found || offset_ns < min_offset_ns) min_offset_ns = offset_ns;
+                    if(!found || max_offset_ns < offset_ns) max_offset_ns = offset_ns;
+                    found = true;
+                    return true;
+                });
+                return found;
+            }
+
+            std::int64_t firstOffsetNanos() const
+            { return first_offset_ns; };
+
+            std::int64_t lastOffsetNanos() const
+            { return last_offset_ns; };
+
+            bool isFinalized() const
+            { return finalized; };
+
+            // false if first offsets of chunks are not monotonic (e.g. custom time calculator)
+            bool isSorted() const
+            { return sorted; };
+
+            // true if file is opened with seek index in trailer (finalized file of version 4 or later)
+            bool isIndexed() const
+            { return indexed; };
+
+            const MappedFile &mappedFile() const
+            { return file; };
+
+            // empty if file is written by version 2 or older
+            const detail::native::dictionary &dictionary() const
+            { return dict; };
+
+            std::uint32_t fileVersion() const
+            { return file_version; };
+
+            // counts records per address id without decoding messages.
+            // returns false if file has no dictionary (version 2 or older)
+            bool countAddresses(std::vector<std::size_t> &counts) const {
+                if(file_version < 3) return false;
+                counts.assign(dict.addresses.size(), 0);
+                for(const auto &chunk : chunks) {
+                    walkChunk(chunk, [&counts](std::int64_t, detail::native::binary_reader &record_reader) {
+                        auto id = static_cast<std::size_t>(peekAddressId(record_reader));
+                        if(id < counts.size()) ++counts[id];
+                        return true;
+                    });
+                }
+                return true;
+            }
+
+        private:
+            MappedFile file;
+            Metadata meta;
+            detail::native::dictionary dict;
+            std::vector<chunk_entry> chunks;
+            std::uint64_t num_records{0};
+            std::uint32_t file_version{detail::native::version};
+            std::int64_t first_offset_ns{0};
+            std::int64_t last_offset_ns{0};
+            bool finalized{false};
+            bool sorted{true};
+            bool indexed{false};
+
+            // records of RECZ chunk restored by walkChunk
+            struct plain_chunk {
+                std::size_t head{0}; // position of chunk in file
+                std::vector<std::uint8_t> records;
+            };
+            // the last restored chunk. lazy playback walks same chunk for each short window.
+            // it is not modified after restored, so walking threads share it
+            mutable std::mutex plain_cache_mutex;
+            mutable std::shared_ptr<const plain_chunk> plain_cache;
+
+            // opens by footer, TAIL, META, last DICT and INDX chunks.
+            // pages of RECS chunks are not touched.
+            bool openIndexed() {
+                const auto data = file.data();
+                const auto size = file.size();
+                if(size < detail::native::header_size + detail::native::footer_size) return false;
+                const auto footer = data + size - detail::native::footer_size;
+                if(std::memcmp(footer + 8, detail::native::footer_magic, sizeof(detail::native::footer_magic)) != 0) return false;
+
+                // returns payload and size of chunk with tag at position
+                auto chunk_at = [&](std::uint64_t position, std::uint32_t tag, std::size_t &chunk_size) -> const std::uint8_t * {
+                    if(position < detail::native::header_size || size < position + detail::native::chunk_header_size) return nullptr;
+                    detail::native::binary_reader reader{data + position, detail::native::chunk_header_size};
+                    if(reader.read_u32() != tag) return nullptr;
+                    chunk_size = reader.read_u32();
+                    auto payload = position + detail::native::chunk_header_size;
+                    if(size - payload < chunk_size) return nullptr;
+                    return data + payload;
+                };
+
+                std::size_t trailer_size = 0, index_size = 0, dictionary_size = 0, metadata_size = 0;
+                detail::native::binary_reader footer_reader{footer, 8};
+                auto trailer = chunk_at(footer_reader.read_u64(), detail::native::tag_trailer, trailer_size);
+                if(trailer == nullptr) return false;
+                detail::native::binary_reader trailer_reader{trailer, trailer_size};
+                auto positions = detail::native::read_trailer_positions(trailer_reader, file_version);
+                auto index = chunk_at(positions.index, detail::native::tag_index, index_size);
+                if(index == nullptr || !trailer_reader.good()) return false;
+                if(positions.dictionary != 0) {
+                    auto dictionary = chunk_at(positions.dictionary, detail::native::tag_dictionary, dictionary_size);
+                    if(dictionary == nullptr || !dict.read(dictionary, dictionary_size)) return false;
+                }
+                auto metadata = chunk_at(detail::native::header_size, detail::native::tag_metadata, metadata_size);
+                if(metadata != nullptr) detail::native::decode_metadata(metadata, metadata_size, meta);
+                detail::native::decode_metadata(trailer + trailer_reader.position(), trailer_reader.remaining(), meta);
+
+                detail::native::binary_reader index_reader{index, index_size};
+                index_reader.read_i64(); // interval
+                auto num_entries = index_reader.read_u32();
+                chunks.reserve(num_entries);
+                for(std::uint32_t i = 0; i < num_entries && index_reader.good(); ++i) {
+                    auto position = index_reader.read_u64();
+                    std::size_t chunk_size = index_reader.read_u32();
+                    chunk_entry entry;
+                    entry.num_records = index_reader.read_u32();
+                    entry.min_offset_ns = index_reader.read_i64();
+                    entry.max_offset_ns = index_reader.read_i64();
+                    entry.first_offset_ns = entry.min_offset_ns;
+                    entry.head = position;
+                    entry.end = position + detail::native::chunk_header_size + chunk_size;
+                    entry.first_index = num_records;
+                    if(size < entry.end || entry.end < entry.head + detail::native::chunk_header_size + 4) return false;
+                    if(!chunks.empty() && entry.first_offset_ns < chunks.back().first_offset_ns) sorted = false;
+                    chunks.push_back(entry);
+                    num_records += entry.num_records;
+                }
+                if(!index_reader.good() || num_records != positions.num_records) return false;
+
+                first_offset_ns = last_offset_ns = 0;
+                if(!chunks.empty()) {
+                    first_offset_ns = chunks.front().min_offset_ns;
+                    auto max_until = chunks.front().max_offset_ns;
+                    for(auto &chunk : chunks) {
+                        max_until = (std::max)(max_until, chunk.max_offset_ns);
+                        chunk.max_offset_until_ns = max_until;
+                    }
+                    auto min_after = chunks.back().min_offset_ns;
+                    for(auto it = chunks.rbegin(); it != chunks.rend(); ++it) {
+                        min_after = (std::min)(min_after, it->min_offset_ns);
+                        it->min_offset_after_ns = min_after;
+                    }
+                    last_offset_ns = max_until;
+                }
+                finalized = true;
+                indexed = true;
+                return true;
+            }
+
+            // only for version 3 or later. reader is not moved
+            static std::uint32_t peekAddressId(const detail::native::binary_reader &record_reader) {
+                // offset(i64) timetag(u64) address_id(varint)
+                auto reader = record_reader;
+                reader.read_u64();
+                reader.read_u64();
+                auto id = reader.read_varint();
+                return reader.good() ? static_cast<std::uint32_t>(id) : SequenceData::unknown_address_id;
+            }
+
+            std::int64_t readOffset(detail::native::binary_reader &reader) const {
+                if(file_version < 2) return std::llround(reader.read_f64() * 1000000000.0);
+                return reader.read_i64();
+            }
+
+            // nullptr if chunk is broken. chunk is restored out of lock, so other chunks are restored concurrently
+            std::shared_ptr<const plain_chunk> restoreChunk(const chunk_entry &chunk,
+                                                            const std::uint8_t *payload,
+                                                            std::size_t payload_size) const
+            {
+                {
+                    auto &&_ = std::lock_guard<decltype(plain_cache_mutex)>(plain_cache_mutex);
+                    if(plain_cache && plain_cache->head == chunk.head) return plain_cache;
+                }
+                auto plain = std::make_shared<plain_chunk>();
+                if(!detail::native::decompress_records(payload, payload_size, plain->records)) return nullptr;
+                plain->head = chunk.head;
+                auto &&_ = std::lock_guard<decltype(plain_cache_mutex)>(plain_cache_mutex);
+                plain_cache = plain;
+                return plain;
+            }
+
+            // callback: bool(std::int64_t offset_ns, binary_reader &record) returns false to stop
+            template <typename callback_t>
+            void walkChunk(const chunk_entry &chunk, callback_t callback) const {
+                detail::native::binary_reader chunk_reader{file.data() + chunk.head, detail::native::chunk_header_size};
+                auto tag = chunk_reader.read_u32();
+                const std::uint8_t *payload = file.data() + chunk.head + detail::native::chunk_header_size;
+                std::size_t payload_size = chunk.end - (chunk.head + detail::native::chunk_header_size);
+                // messages of packets are decoded into records per walk
+                if(tag == detail::native::tag_packets) {
+                    std::vector<std::uint8_t> scratch;
+                    bool stopped = false;
+                    detail::native::for_each_framed_packet(payload, payload_size, [&](const std::uint8_t *p, std::size_t size) {
+                        if(stopped) return;
+                        detail::native::for_each_packet_record(p, size, scratch, [&](std::int64_t offset_ns, detail::native::binary_reader &record_reader) {
+                            stopped = !callback(offset_ns, record_reader);
+                            return !stopped;
+                        });
+                    });
+                    return;
+                }
+                // compressed chunk is restored once while it is walked repeatedly
+                std::shared_ptr<const plain_chunk> plain;
+                if(tag == detail::native::tag_compressed_records) {
+                    plain = restoreChunk(chunk, payload, payload_size);
+                    if(!plain) {
+                        ofLogWarning("ofxRecordOsc") << "broken chunk is skipped.";
+                        return;
+                    }
+                    payload = plain->records.data();
+                    payload_size = plain->records.size();
+                }
+                if(payload_size < 4) return;
+                // skip num_records(u32)
+                detail::native::binary_reader reader{payload + 4, payload_size - 4};
+                for(std::uint32_t i = 0; i < chunk.num_records; ++i) {
+                    auto record_size = reader.read_u32();
+                    auto record = reader.read_bytes(record_size);
+                    if(record == nullptr) return;
+                    detail::native::binary_reader offset_reader{record, record_size};
+                    auto offset_ns = readOffset(offset_reader);
+                    detail::native::binary_reader record_reader{record, record_size};
+                    if(!callback(offset_ns, record_reader)) return;
+                }
+            }
+
+            bool decode(detail::native::binary_reader &record_reader,
+                        SequenceData &data,
+                        std::uint64_t sequence) const
+            {
+                if(!detail::native::read_record(record_reader, data, file_version, dict)) {
+                    ofLogWarning("ofxRecordOsc") << "broken record is skipped.";
+                    return false;
+                }
+                data.sequence = sequence;
+                return true;
+            }
+        }; // struct NativeMappedReader
+
+        namespace detail {
+            inline ofJson load_native(const std::string &filepath) {
+                NativeReader reader;
+                ofJson sequence = ofJson::array();
+                reader.read(filepath, [&sequence](const SequenceData &data) {
+                    sequence.push_back(data);
+                });
+                ofJson json = ofJson::object();
+                json["metadata"] = reader.metadata();
+                json["sequence"] = std::move(sequence);
+                return json;
+            }
+
+            inline bool save_native(const std::string &filepath,
+                                    const ofJson &json)
+            {
+                NativeWriter writer;
+                Metadata metadata = json["metadata"];
+                if(!writer.open(filepath, metadata)) return false;
+                SequenceData data;
+                for(const auto &record : json["sequence"]) {
+                    data.mess.clear();
+                    from_json(record, data);
+                    writer.append(data);
+                }
+                return writer.close(metadata);
+            }
+        }; // namespace detail
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscCompression = ofx::RecordOsc::Compression;
+using ofxRecordOscNativeWriter = ofx::RecordOsc::NativeWriter;
+using ofxRecordOscNativeReader = ofx::RecordOsc::NativeReader;
+using ofxRecordOscNativeMappedReader = ofx::RecordOsc::NativeMappedReader;
+
+#endif /* ofxRecordOscNativeFormat_h */
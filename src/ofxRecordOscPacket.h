@@ -0,0 +1,264 @@
+//
+//  ofxRecordOscPacket.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscPacket_h
+#define ofxRecordOscPacket_h
+
+#include "ofxOscMessageEx.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <limits>
+
+namespace ofx {
+    namespace RecordOsc {
+        // OSC datagram as received, message or bundle. see Recorder::listenRaw
+        struct RawPacket {
+            std::int64_t offset_ns{0};
+            std::string host;               // source endpoint
+            std::uint16_t port{0};
+            std::uint16_t received_port{0}; // port of recorder
+            std::vector<std::uint8_t> bytes;
+
+            double offset() const
+            { return offset_ns / 1000000000.0; };
+        };
+
+        namespace detail {
+            // minimal reader / writer of OSC wire format. reader allocates nothing.
+            namespace osc {
+                constexpr char bundle_tag[8] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', '\0'};
+                constexpr std::size_t max_bundle_depth = 8;
+
+                inline std::uint32_t read_be32(const std::uint8_t *p) {
+                    return (static_cast<std::uint32_t>(p[0]) << 24)
+                        | (static_cast<std::uint32_t>(p[1]) << 16)
+                        | (static_cast<std::uint32_t>(p[2]) << 8)
+                        | static_cast<std::uint32_t>(p[3]);
+                }
+
+                inline std::uint64_t read_be64(const std::uint8_t *p)
+                { return (static_cast<std::uint64_t>(read_be32(p)) << 32) | read_be32(p + 4); };
+
+                // size of null terminated and 4 byte padded string at p, 0 if it is broken
+                inline std::size_t padded_string_size(const std::uint8_t *p, const std::uint8_t *end) {
+                    auto terminator = static_cast<const std::uint8_t *>(std::memchr(p, 0, end - p));
+                    if(terminator == nullptr) return 0;
+                    auto size = (static_cast<std::size_t>(terminator - p) / 4 + 1) * 4;
+                    return static_cast<std::size_t>(end - p) < size ? 0 : size;
+                }
+
+                struct message_view {
+                    std::uint64_t timetag;          // of innermost bundle, 0 if message is not bundled
+                    const char *address;
+                    std::size_t address_length;
+                    const char *typetags;           // without ','
+                    std::size_t num_typetags;
+                    const std::uint8_t *arguments;
+                    const std::uint8_t *end;
+
+                    bool isAddress(const std::string &x) const
+                    { return x.length() == address_length && std::memcmp(x.data(), address, address_length) == 0; };
+
+                    std::size_t numArgs() const
+                    { return num_typetags; };
+                };
+
+                inline bool read_message(const std::uint8_t *data,
+                                         std::size_t size,
+                                         std::uint64_t timetag,
+                                         message_view &message)
+                {
+                    const auto end = data + size;
+                    if(size == 0 || data[0] != '/') return false;
+                    auto address_size = padded_string_size(data, end);
+                    if(address_size == 0) return false;
+                    message.timetag = timetag;
+                    message.address = reinterpret_cast<const char *>(data);
+                    message.address_length = std::strlen(message.address);
+                    auto p = data + address_size;
+                    message.typetags = "";
+                    message.num_typetags = 0;
+                    // typetag string can be omitted by old implementations
+                    if(p < end && *p == ',') {
+                        auto typetags_size = padded_string_size(p, end);
+                        if(typetags_size == 0) return false;
+                        message.typetags = reinterpret_cast<const char *>(p + 1);
+                        message.num_typetags = std::strlen(message.typetags);
+                        p += typetags_size;
+                    }
+                    message.arguments = p;
+                    message.end = end;
+                    return true;
+                }
+
+                // callback: void(const message_view &), in order of packet.
+                // returns false if packet is broken. messages before broken part are passed
+                template <typename callback_t>
+                bool for_each_message(const std::uint8_t *data,
+                                      std::size_t size,
+                                      callback_t &&callback,
+                                      std::uint64_t timetag = 0,
+                                      std::size_t depth = 0)
+                {
+                    if(size < 16 || std::memcmp(data, bundle_tag, sizeof(bundle_tag)) != 0) {
+                        message_view message;
+                        if(!read_message(data, size, timetag, message)) return false;
+                        callback(static_cast<const message_view &>(message));
+                        return true;
+                    }
+                    if(max_bundle_depth <= depth) return false;
+                    auto bundle_timetag = read_be64(data + 8);
+                    std::size_t p = 16;
+                    while(p + 4 <= size) {
+                        std::size_t element_size = read_be32(data + p);
+                        p += 4;
+                        if(size - p < element_size) return false;
+                        if(!for_each_message(data + p, element_size, callback, bundle_timetag, depth + 1)) return false;
+                        p += element_size;
+                    }
+                    return p == size;
+                }
+
+                // value of first argument as double, NaN if it is not numeric
+                inline double first_arg_as_double(const message_view &message) {
+                    auto nan = std::numeric_limits<double>::quiet_NaN();
+                    if(message.num_typetags == 0) return nan;
+                    auto remaining = static_cast<std::size_t>(message.end - message.arguments);
+                    auto p = message.arguments;
+                    switch(message.typetags[0]) {
+                        case 'i': {
+                            if(remaining < 4) return nan;
+                            return static_cast<std::int32_t>(read_be32(p));
+                        }
+                        case 'f': {
+                            if(remaining < 4) return nan;
+                            auto bits = read_be32(p);
+                            float value;
+                            std::memcpy(&value, &bits, sizeof(value));
+                            return value;
+                        }
+                        case 'h': {
+                            if(remaining < 8) return nan;
+                            return static_cast<double>(static_cast<std::int64_t>(read_be64(p)));
+                        }
+                        case 'd': {
+                            if(remaining < 8) return nan;
+                            auto bits = read_be64(p);
+                            double value;
+                            std::memcpy(&value, &bits, sizeof(value));
+                            return value;
+                        }
+                        case 'T': return 1.0;
+                        case 'F': return 0.0;
+                        default: return nan;
+                    }
+                }
+
+                // writer of OSC wire format, appends to out
+                inline void write_be32(std::vector<std::uint8_t> &out, std::uint32_t v) {
+                    std::uint8_t bytes[4] = {
+                        static_cast<std::uint8_t>(v >> 24),
+                        static_cast<std::uint8_t>(v >> 16),
+                        static_cast<std::uint8_t>(v >> 8),
+                        static_cast<std::uint8_t>(v)
+                    };
+                    out.insert(out.end(), bytes, bytes + 4);
+                }
+
+                inline void write_be64(std::vector<std::uint8_t> &out, std::uint64_t v) {
+                    write_be32(out, static_cast<std::uint32_t>(v >> 32));
+                    write_be32(out, static_cast<std::uint32_t>(v));
+                }
+
+                // null terminated, padded to 4 bytes
+                inline void write_padded_string(std::vector<std::uint8_t> &out, const char *str, std::size_t length) {
+                    out.insert(out.end(), str, str + length);
+                    out.resize(out.size() + 4 - length % 4, 0);
+                }
+
+                inline void write_padded_bytes(std::vector<std::uint8_t> &out, const char *data, std::size_t size) {
+                    out.insert(out.end(), data, data + size);
+                    out.resize(out.size() + (4 - size % 4) % 4, 0);
+                }
+
+                // appends mess as OSC message
+                inline void write_message(std::vector<std::uint8_t> &out, const ofxOscMessageEx &mess) {
+                    const auto &address = mess.getAddress();
+                    write_padded_string(out, address.data(), address.length());
+
+                    // typetags are written in place, without temporary string
+                    const std::size_t num_args = mess.getNumArgs();
+                    const auto typetags_position = out.size();
+                    out.push_back(',');
+                    for(std::size_t i = 0; i < num_args; ++i) {
+                        auto type = mess.getArgType(i);
+                        if(type != OFXOSC_TYPE_INDEXOUTOFBOUNDS) out.push_back(static_cast<std::uint8_t>(type));
+                    }
+                    out.resize(out.size() + 4 - (out.size() - typetags_position) % 4, 0);
+
+                    for(std::size_t i = 0; i < num_args; ++i) {
+                        switch(mess.getArgType(i)) {
+                            case OFXOSC_TYPE_INT32:
+                                write_be32(out, static_cast<std::uint32_t>(mess.getArgAsInt32(i)));
+                                break;
+                            case OFXOSC_TYPE_CHAR:
+                                write_be32(out, static_cast<std::uint32_t>(mess.getArgAsChar(i)));
+                                break;
+                            case OFXOSC_TYPE_MIDI_MESSAGE:
+                                write_be32(out, mess.getArgAsMidiMessage(i));
+                                break;
+                            case OFXOSC_TYPE_RGBA_COLOR:
+                                write_be32(out, mess.getArgAsRgbaColor(i));
+                                break;
+                            case OFXOSC_TYPE_FLOAT: {
+                                float value = mess.getArgAsFloat(i);
+                                std::uint32_t bits;
+                                std::memcpy(&bits, &value, sizeof(bits));
+                                write_be32(out, bits);
+                                break;
+                            }
+                            case OFXOSC_TYPE_INT64:
+                                write_be64(out, static_cast<std::uint64_t>(mess.getArgAsInt64(i)));
+                                break;
+                            case OFXOSC_TYPE_TIMETAG:
+                                write_be64(out, mess.getArgAsTimetag(i));
+                                break;
+                            case OFXOSC_TYPE_DOUBLE: {
+                                double value = mess.getArgAsDouble(i);
+                                std::uint64_t bits;
+                                std::memcpy(&bits, &value, sizeof(bits));
+                                write_be64(out, bits);
+                                break;
+                            }
+                            case OFXOSC_TYPE_STRING:
+                            case OFXOSC_TYPE_SYMBOL: {
+                                auto &&str = mess.getArgAsString(i);
+                                write_padded_string(out, str.data(), str.length());
+                                break;
+                            }
+                            case OFXOSC_TYPE_BLOB: {
+                                auto &&blob = mess.getArgAsBlob(i);
+                                write_be32(out, static_cast<std::uint32_t>(blob.size()));
+                                write_padded_bytes(out, blob.getData(), blob.size());
+                                break;
+                            }
+                            default:
+                                // T, F, N, I have no data
+                                break;
+                        }
+                    }
+                }
+            }; // namespace osc
+        }; // namespace detail
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscRawPacket = ofx::RecordOsc::RawPacket;
+
+#endif /* ofxRecordOscPacket_h */
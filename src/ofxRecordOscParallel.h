@@ -0,0 +1,66 @@
+//
+//  ofxRecordOscParallel.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscParallel_h
+#define ofxRecordOscParallel_h
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+
+namespace ofx {
+    namespace RecordOsc {
+        namespace detail {
+            inline std::size_t hardware_threads() {
+                auto num = std::thread::hardware_concurrency();
+                return num ? num : 1;
+            }
+
+            // calls task(i) for all i in [0, num_tasks) on up to num_threads threads including caller.
+            // tasks are taken from shared counter, so uneven tasks are balanced.
+            // returns after all tasks are done.
+            template <typename task_t>
+            void parallel_for(std::size_t num_tasks,
+                              std::size_t num_threads,
+                              task_t task)
+            {
+                num_threads = (std::min)(num_threads, num_tasks);
+                if(num_threads <= 1) {
+                    for(std::size_t i = 0; i < num_tasks; ++i) task(i);
+                    return;
+                }
+                std::atomic<std::size_t> next{0};
+                auto work = [&] {
+                    for(auto i = next.fetch_add(1); i < num_tasks; i = next.fetch_add(1)) task(i);
+                };
+                std::vector<std::thread> threads;
+                threads.reserve(num_threads - 1);
+                for(std::size_t i = 1; i < num_threads; ++i) threads.emplace_back(work);
+                work();
+                for(auto &thread : threads) thread.join();
+            }
+
+            // splits [0, size) into parts of at least min_part_size for num_threads threads.
+            // part i is [bounds[i], bounds[i + 1])
+            inline std::vector<std::size_t> split_range(std::size_t size,
+                                                        std::size_t num_threads,
+                                                        std::size_t min_part_size = 4096)
+            {
+                // a few parts per thread for balancing
+                auto num_parts = (std::min)((std::max<std::size_t>)(num_threads, 1) * 4,
+                                            (size + min_part_size - 1) / min_part_size);
+                num_parts = (std::max<std::size_t>)(num_parts, 1);
+                std::vector<std::size_t> bounds(num_parts + 1);
+                for(std::size_t i = 0; i <= num_parts; ++i) bounds[i] = size * i / num_parts;
+                return bounds;
+            }
+        }; // namespace detail
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+#endif /* ofxRecordOscParallel_h */
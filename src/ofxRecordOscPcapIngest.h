@@ -0,0 +1,586 @@
+//
+//  ofxRecordOscPcapIngest.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscPcapIngest_h
+#define ofxRecordOscPcapIngest_h
+
+#include "ofxRecordOscData.h"
+#include "ofxRecordOscMappedFile.h"
+#include "ofxRecordOscMetrics.h"
+#include "ofxRecordOscNativeFormat.h"
+#include "ofxRecordOscPacket.h"
+#include "ofxRecordOscParallel.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+
+namespace ofx {
+    namespace RecordOsc {
+        namespace detail {
+            // reader of capture files of tcpdump / wireshark (pcap and pcapng).
+            // nothing is copied, frames point into mapped file.
+            namespace pcap {
+                struct frame {
+                    std::int64_t timestamp_ns;  // since unix epoch
+                    std::uint32_t link_type;
+                    const std::uint8_t *data;
+                    std::size_t size;           // captured length
+                };
+
+                struct reader {
+                    // returns false if data is neither pcap nor pcapng
+                    bool open(const std::uint8_t *data, std::size_t size) {
+                        this->data = data;
+                        this->size = size;
+                        position = 0;
+                        broken = false;
+                        interfaces.clear();
+                        if(size < 24) return false;
+                        auto magic = read_u32_le(data);
+                        if(magic == pcapng_section_magic) {
+                            is_ng = true;
+                            return true;
+                        }
+                        is_ng = false;
+                        switch(magic) {
+                            case 0xA1B2C3D4: swapped = false; nano = false; break;
+                            case 0xD4C3B2A1: swapped = true;  nano = false; break;
+                            case 0xA1B23C4D: swapped = false; nano = true;  break;
+                            case 0x4D3CB2A1: swapped = true;  nano = true;  break;
+                            default: return false;
+                        }
+                        // upper bits of link type can have FCS length
+                        link_type = u32(data + 20) & 0x0FFFFFFF;
+                        position = 24;
+                        return true;
+                    }
+
+                    // false at the end of data or at broken part
+                    bool next(frame &f) {
+                        return is_ng ? nextBlock(f) : nextRecord(f);
+                    }
+
+                    bool isBroken() const
+                    { return broken; };
+
+                private:
+                    static constexpr std::uint32_t pcapng_section_magic = 0x0A0D0D0A;
+                    static constexpr std::uint32_t pcapng_byte_order_magic = 0x1A2B3C4D;
+
+                    struct interface {
+                        std::uint32_t link_type;
+                        std::uint8_t resolution; // if_tsresol
+                    };
+
+                    const std::uint8_t *data{nullptr};
+                    std::size_t size{0};
+                    std::size_t position{0};
+                    bool is_ng{false};
+                    bool swapped{false};
+                    bool nano{false};
+                    bool broken{false};
+                    std::uint32_t link_type{0};
+                    std::vector<interface> interfaces; // of current section
+
+                    static std::uint32_t read_u32_le(const std::uint8_t *p) {
+                        return static_cast<std::uint32_t>(p[0])
+                            | (static_cast<std::uint32_t>(p[1]) << 8)
+                            | (static_cast<std::uint32_t>(p[2]) << 16)
+                            | (static_cast<std::uint32_t>(p[3]) << 24);
+                    }
+
+                    std::uint32_t u32(const std::uint8_t *p) const
+                    { return swapped ? osc::read_be32(p) : read_u32_le(p); };
+
+                    std::uint16_t u16(const std::uint8_t *p) const {
+                        return swapped
+                            ? static_cast<std::uint16_t>((p[0] << 8) | p[1])
+                            : static_cast<std::uint16_t>(p[0] | (p[1] << 8));
+                    }
+
+                    bool nextRecord(frame &f) {
+                        if(size - position < 16) {
+                            broken = position != size;
+                            return false;
+                        }
+                        auto p = data + position;
+                        std::size_t captured = u32(p + 8);
+                        if(size - position - 16 < captured) {
+                            broken = true;
+                            return false;
+                        }
+                        f.timestamp_ns = static_cast<std::int64_t>(u32(p)) * 1000000000
+                                       + static_cast<std::int64_t>(u32(p + 4)) * (nano ? 1 : 1000);
+                        f.link_type = link_type;
+                        f.data = p + 16;
+                        f.size = captured;
+                        position += 16 + captured;
+                        return true;
+                    }
+
+                    bool nextBlock(frame &f) {
+                        while(position + 12 <= size) {
+                            auto p = data + position;
+                            auto type = read_u32_le(p);
+                            if(type == pcapng_section_magic) {
+                                // byte order of section is given by its magic
+                                if(size - position < 28) break;
+                                auto byte_order = read_u32_le(p + 8);
+                                if(byte_order == pcapng_byte_order_magic) swapped = false;
+                                else if(byte_order == 0x4D3C2B1A) swapped = true;
+                                else break;
+                                interfaces.clear();
+                            } else {
+                                type = u32(p);
+                            }
+                            std::size_t length = u32(p + 4);
+                            if(length < 12 || size - position < length) break;
+                            position += length;
+                            auto body = p + 8;
+                            auto body_size = length - 12;
+                            switch(type) {
+                                case 1: { // interface description
+                                    if(body_size < 8) break;
+                                    interfaces.push_back({u16(body), 6});
+                                    readInterfaceOptions(body + 8, body_size - 8, interfaces.back());
+                                    break;
+                                }
+                                case 6:   // enhanced packet
+                                case 2: { // packet (obsolete)
+                                    if(body_size < 20) break;
+                                    std::uint32_t interface_id = type == 6 ? u32(body) : u16(body);
+                                    if(interfaces.size() <= interface_id) break;
+                                    std::uint64_t ticks = (static_cast<std::uint64_t>(u32(body + 4)) << 32) | u32(body + 8);
+                                    std::size_t captured = u32(body + 12);
+                                    if(body_size - 20 < captured) break;
+                                    const auto &i = interfaces[interface_id];
+                                    f.timestamp_ns = to_nanos(ticks, i.resolution);
+                                    f.link_type = i.link_type;
+                                    f.data = body + 20;
+                                    f.size = captured;
+                                    return true;
+                                }
+                                default:
+                                    // simple packet has no timestamp, other blocks have no packet
+                                    break;
+                            }
+                        }
+                        broken = position != size;
+                        return false;
+                    }
+
+                    void readInterfaceOptions(const std::uint8_t *p, std::size_t length, interface &i) const {
+                        std::size_t q = 0;
+                        while(q + 4 <= length) {
+                            auto code = u16(p + q);
+                            std::size_t option_length = u16(p + q + 2);
+                            if(code == 0 || length - q - 4 < option_length) return;
+                            if(code == 9 && option_length == 1) i.resolution = p[q + 4];
+                            q += 4 + ((option_length + 3) & ~static_cast<std::size_t>(3));
+                        }
+                    }
+
+                    // if_tsresol: 10^-n, or 2^-n if MSB is set
+                    static std::int64_t to_nanos(std::uint64_t ticks, std::uint8_t resolution) {
+                        auto exponent = resolution & 0x7F;
+                        if(resolution & 0x80) {
+                            if(exponent == 0) return static_cast<std::int64_t>(ticks) * 1000000000;
+                            if(63 < exponent) return 0;
+                            auto mask = (static_cast<std::uint64_t>(1) << exponent) - 1;
+                            auto fraction = exponent <= 34
+                                          ? ((ticks & mask) * 1000000000) >> exponent
+                                          : static_cast<std::uint64_t>((ticks & mask) * (1000000000.0 / (mask + 1.0)));
+                            return static_cast<std::int64_t>((ticks >> exponent) * 1000000000 + fraction);
+                        }
+                        std::int64_t value = static_cast<std::int64_t>(ticks);
+                        for(auto e = exponent; e < 9; ++e) value *= 10;
+                        for(auto e = exponent; 9 < e; --e) value /= 10;
+                        return value;
+                    }
+                }; // struct reader
+
+                enum class datagram_status {
+                    udp,
+                    not_udp,     // other protocol or unknown link type
+                    fragmented,  // IP fragment. not reassembled
+                    truncated    // cut by snap length
+                };
+
+                struct datagram {
+                    std::uint16_t source_port;
+                    std::uint16_t destination_port;
+                    const std::uint8_t *payload;
+                    std::size_t payload_size;
+                };
+
+                inline std::uint16_t read_be16(const std::uint8_t *p)
+                { return static_cast<std::uint16_t>((p[0] << 8) | p[1]); };
+
+                inline void format_ipv4(const std::uint8_t *p, std::string &host) {
+                    char buf[16];
+                    std::snprintf(buf, sizeof(buf), "%u.%u.%u.%u", p[0], p[1], p[2], p[3]);
+                    host.assign(buf);
+                }
+
+                inline void format_ipv6(const std::uint8_t *p, std::string &host) {
+                    char buf[40];
+                    std::snprintf(buf, sizeof(buf), "%x:%x:%x:%x:%x:%x:%x:%x",
+                                  read_be16(p), read_be16(p + 2), read_be16(p + 4), read_be16(p + 6),
+                                  read_be16(p + 8), read_be16(p + 10), read_be16(p + 12), read_be16(p + 14));
+                    host.assign(buf);
+                }
+
+                // UDP in IPv4 / IPv6 over ethernet (with VLAN tags), BSD loopback, raw IP and linux cooked capture.
+                // source address is written to host
+                inline datagram_status read_udp(const frame &f, datagram &d, std::string &host) {
+                    const auto end = f.data + f.size;
+                    auto p = f.data;
+                    std::uint16_t ether_type = 0; // 0 is guessed from IP version
+                    auto remains = [&](std::size_t n) { return n <= static_cast<std::size_t>(end - p); };
+                    switch(f.link_type) {
+                        case 1: // ethernet
+                            if(!remains(14)) return datagram_status::truncated;
+                            ether_type = read_be16(p + 12);
+                            p += 14;
+                            while(ether_type == 0x8100 || ether_type == 0x88A8) {
+                                if(!remains(4)) return datagram_status::truncated;
+                                ether_type = read_be16(p + 2);
+                                p += 4;
+                            }
+                            break;
+                        case 0:   // BSD loopback, family in host byte order
+                        case 108: // OpenBSD loopback
+                            if(!remains(4)) return datagram_status::truncated;
+                            p += 4;
+                            break;
+                        case 12:  // raw IP
+                        case 14:
+                        case 101:
+                        case 228: // IPv4
+                        case 229: // IPv6
+                            break;
+                        case 113: // linux cooked capture
+                            if(!remains(16)) return datagram_status::truncated;
+                            ether_type = read_be16(p + 14);
+                            p += 16;
+                            break;
+                        case 276: // linux cooked capture v2
+                            if(!remains(20)) return datagram_status::truncated;
+                            ether_type = read_be16(p);
+                            p += 20;
+                            break;
+                        default:
+                            return datagram_status::not_udp;
+                    }
+                    if(!remains(1)) return datagram_status::truncated;
+                    auto version = p[0] >> 4;
+                    if((ether_type == 0x0800 && version != 4) || (ether_type == 0x86DD && version != 6)) return datagram_status::not_udp;
+                    if(ether_type != 0 && ether_type != 0x0800 && ether_type != 0x86DD) return datagram_status::not_udp;
+
+                    std::size_t ip_payload_size = 0;
+                    if(version == 4) {
+                        if(!remains(20)) return datagram_status::truncated;
+                        std::size_t header_size = (p[0] & 0x0F) * 4;
+                        std::size_t total_size = read_be16(p + 2);
+                        if(header_size < 20 || total_size < header_size) return datagram_status::not_udp;
+                        if(p[9] != 17) return datagram_status::not_udp;
+                        // more fragments flag or fragment offset
+                        if(read_be16(p + 6) & 0x3FFF) return datagram_status::fragmented;
+                        if(!remains(header_size)) return datagram_status::truncated;
+                        format_ipv4(p + 12, host);
+                        ip_payload_size = total_size - header_size;
+                        p += header_size;
+                    } else if(version == 6) {
+                        if(!remains(40)) return datagram_status::truncated;
+                        std::size_t payload_size = read_be16(p + 4);
+                        auto next_header = p[6];
+                        format_ipv6(p + 8, host);
+                        p += 40;
+                        // hop-by-hop, routing and destination options are skipped
+                        while(next_header == 0 || next_header == 43 || next_header == 60) {
+                            if(!remains(2)) return datagram_status::truncated;
+                            std::size_t extension_size = (p[1] + 1) * 8;
+                            if(!remains(extension_size) || payload_size < extension_size) return datagram_status::truncated;
+                            next_header = p[0];
+                            p += extension_size;
+                            payload_size -= extension_size;
+                        }
+                        if(next_header == 44) return datagram_status::fragmented;
+                        if(next_header != 17) return datagram_status::not_udp;
+                        ip_payload_size = payload_size;
+                    } else {
+                        return datagram_status::not_udp;
+                    }
+
+                    if(!remains(8)) return datagram_status::truncated;
+                    std::size_t udp_size = read_be16(p + 4);
+                    // jumbogram of IPv6 has 0 in length of UDP
+                    if(udp_size == 0) udp_size = ip_payload_size;
+                    if(udp_size < 8) return datagram_status::not_udp;
+                    d.source_port = read_be16(p);
+                    d.destination_port = read_be16(p + 2);
+                    d.payload = p + 8;
+                    d.payload_size = udp_size - 8;
+                    if(!remains(udp_size)) return datagram_status::truncated;
+                    return datagram_status::udp;
+                }
+            }; // namespace pcap
+        }; // namespace detail
+
+        // result of PcapIngest::ingest
+        struct IngestResult {
+            bool succeeded{false};
+            std::string path;
+            FileFormat format{FileFormat::Native};
+            std::uint64_t num_frames{0};      // frames in capture files
+            std::uint64_t num_datagrams{0};   // UDP datagrams to ports
+            std::uint64_t num_records{0};     // OSC messages written
+            std::uint64_t num_skipped{0};     // not UDP or to other ports
+            std::uint64_t num_fragmented{0};  // IP fragments. not reassembled
+            std::uint64_t num_truncated{0};   // cut by snap length of capture
+            std::uint64_t num_broken{0};      // datagrams which are not OSC
+            double duration_sec{0.0};         // length of recording
+            double ingest_duration_ms{0.0};
+        }; // struct IngestResult
+
+        // converts UDP datagrams in pcap / pcapng captures (e.g. tcpdump -w) into a recording,
+        // without replaying them in real time.
+        // offsets are timestamps of capture from the earliest first frame of all files,
+        // frames are parsed and decoded on all cores, records are written by NativeWriter in order.
+        // files are merged by timestamp of frames. each round of frames is sorted by timestamp.
+        struct PcapIngest {
+            // destination ports of datagrams to record. all UDP datagrams are recorded if empty.
+            // ports are stored as Metadata::listening_ports
+            void addPort(std::uint16_t port)
+            { ports.insert(port); };
+
+            void clearPorts()
+            { ports.clear(); };
+
+            const std::set<std::uint16_t> &getPorts() const
+            { return ports; };
+
+            // datagrams are stored as is in PKTS chunks of Native file like Recorder::listenRaw.
+            // other formats store decoded messages anyway
+            void setRawPackets(bool raw)
+            { raw_packets = raw; };
+
+            // compression of Native file. see NativeWriter::setCompression
+            void setCompression(Compression compression)
+            { this->compression = compression; };
+
+            // 0 (default) uses all cores
+            void setThreads(std::size_t num_threads)
+            { this->num_threads = num_threads; };
+
+            std::size_t getThreads() const
+            { return num_threads ? num_threads : detail::hardware_threads(); };
+
+            IngestResult ingest(const std::string &capture_path,
+                                const std::string &output_path,
+                                FileFormat format = FileFormat::Native)
+            { return ingest(std::vector<std::string>{capture_path}, output_path, format); };
+
+            // formats other than Native are converted from Native spool as Recorder does
+            IngestResult ingest(const std::vector<std::string> &capture_paths,
+                                const std::string &output_path,
+                                FileFormat format = FileFormat::Native)
+            {
+                auto started = std::chrono::steady_clock::now();
+                IngestResult result;
+                result.format = format;
+                result.path = ofToDataPath(output_path, true);
+
+                std::vector<std::unique_ptr<MappedFile>> files;
+                std::vector<source> sources;
+                for(const auto &capture_path : capture_paths) {
+                    auto path = ofToDataPath(capture_path, true);
+                    std::unique_ptr<MappedFile> file(new MappedFile);
+                    source s;
+                    s.path = capture_path;
+                    if(!file->open(path) || !s.reader.open(file->data(), file->size())) {
+                        ofLogError("ofxRecordOsc") << path << " is not a pcap / pcapng file.";
+                        return result;
+                    }
+                    file->adviseSequential();
+                    files.push_back(std::move(file));
+                    if(s.advance()) sources.push_back(std::move(s));
+                }
+                // heap of sources by timestamp of their next frame
+                auto later = [](const source &x, const source &y) { return y.head.timestamp_ns < x.head.timestamp_ns; };
+                std::make_heap(sources.begin(), sources.end(), later);
+                std::int64_t capture_start_ns = sources.empty() ? 0 : sources.front().head.timestamp_ns;
+
+                Metadata metadata;
+                metadata.listening_ports = ports;
+                metadata.started_time_str = detail::timestamp_string(capture_start_ns);
+                metadata.started_timestamp = static_cast<std::uint32_t>(capture_start_ns / 1000000000);
+
+                const bool is_native = format == FileFormat::Native;
+                auto spool_path = is_native ? result.path : result.path + ".part.oscrec";
+                NativeWriter writer;
+                writer.setCompression(is_native ? compression : Compression::None);
+                if(!writer.open(spool_path, metadata)) {
+                    ofLogError("ofxRecordOsc") << "can't open " << spool_path;
+                    return result;
+                }
+
+                std::int64_t last_offset_ns = 0;
+                std::vector<detail::pcap::frame> frames;
+                std::vector<part> parts;
+                while(!sources.empty()) {
+                    frames.clear();
+                    while(frames.size() < frames_per_round && !sources.empty()) {
+                        std::pop_heap(sources.begin(), sources.end(), later);
+                        auto &s = sources.back();
+                        frames.push_back(s.head);
+                        if(s.advance()) std::push_heap(sources.begin(), sources.end(), later);
+                        else sources.pop_back();
+                    }
+                    processRound(frames, capture_start_ns, writer, parts, result);
+                    for(const auto &p : parts) last_offset_ns = (std::max)(last_offset_ns, p.max_offset_ns);
+                }
+
+                metadata.finished_timestamp = static_cast<std::uint32_t>((capture_start_ns + last_offset_ns) / 1000000000);
+                metadata.finished_time_str = detail::timestamp_string(capture_start_ns + last_offset_ns);
+                metadata.duration = last_offset_ns / 1000000000.0;
+                metadata.duration_ns = last_offset_ns;
+                result.num_records = writer.numRecords();
+                result.duration_sec = metadata.duration;
+                result.succeeded = writer.close(metadata);
+
+                if(result.succeeded && !is_native) {
+                    auto &&save_data = detail::load(spool_path, FileFormat::Native);
+                    result.succeeded = detail::save(result.path, std::move(save_data), format);
+                    if(result.succeeded) std::remove(spool_path.c_str());
+                    else ofLogError("ofxRecordOsc") << "failed to save data to " << result.path << ". ingested data is remained at " << spool_path;
+                }
+                result.ingest_duration_ms = detail::elapsed_nanos(started, std::chrono::steady_clock::now()) / 1000000.0;
+                return result;
+            }
+
+            // frames read and decoded per round. memory usage is bounded by this
+            std::size_t frames_per_round{256 * 1024};
+
+        private:
+            std::set<std::uint16_t> ports;
+            bool raw_packets{false};
+            Compression compression{Compression::None};
+            std::size_t num_threads{0};
+
+            // capture file being merged with its next frame
+            struct source {
+                std::string path;
+                detail::pcap::reader reader;
+                detail::pcap::frame head;
+
+                bool advance() {
+                    if(reader.next(head)) return true;
+                    if(reader.isBroken()) {
+                        ofLogWarning("ofxRecordOsc") << path << " is truncated. frames before broken part are ingested.";
+                    }
+                    return false;
+                }
+            };
+
+            // framed records (or packets) of a range of frames
+            struct part {
+                std::vector<std::uint8_t> bytes;
+                std::uint64_t num_records{0};
+                std::int64_t max_offset_ns{0};
+                std::uint64_t num_datagrams{0};
+                std::uint64_t num_skipped{0};
+                std::uint64_t num_fragmented{0};
+                std::uint64_t num_truncated{0};
+                std::uint64_t num_broken{0};
+            };
+
+            void processRound(std::vector<detail::pcap::frame> &frames,
+                              std::int64_t capture_start_ns,
+                              NativeWriter &writer,
+                              std::vector<part> &parts,
+                              IngestResult &result) const
+            {
+                auto earlier = [](const detail::pcap::frame &x, const detail::pcap::frame &y) { return x.timestamp_ns < y.timestamp_ns; };
+                if(!std::is_sorted(frames.begin(), frames.end(), earlier)) {
+                    std::stable_sort(frames.begin(), frames.end(), earlier);
+                }
+                auto &&bounds = detail::split_range(frames.size(), getThreads(), 1024);
+                const auto num_parts = bounds.size() - 1;
+                parts.resize(num_parts);
+                detail::parallel_for(num_parts, getThreads(), [&](std::size_t i) {
+                    auto &out = parts[i];
+                    out = part{};
+                    detail::native::intern_cache cache{writer.internTable()};
+                    std::string host;
+                    RawPacket packet;
+                    for(auto k = bounds[i]; k < bounds[i + 1]; ++k) {
+                        const auto &f = frames[k];
+                        detail::pcap::datagram d;
+                        switch(detail::pcap::read_udp(f, d, host)) {
+                            case detail::pcap::datagram_status::udp:
+                                break;
+                            case detail::pcap::datagram_status::fragmented:
+                                ++out.num_fragmented;
+                                continue;
+                            case detail::pcap::datagram_status::truncated:
+                                ++out.num_truncated;
+                                continue;
+                            default:
+                                ++out.num_skipped;
+                                continue;
+                        }
+                        if(!ports.empty() && ports.find(d.destination_port) == ports.end()) {
+                            ++out.num_skipped;
+                            continue;
+                        }
+                        ++out.num_datagrams;
+                        auto offset_ns = f.timestamp_ns - capture_start_ns;
+                        out.max_offset_ns = (std::max)(out.max_offset_ns, offset_ns);
+                        if(raw_packets) {
+                            // broken packet is recorded as is
+                            packet.offset_ns = offset_ns;
+                            packet.host = host;
+                            packet.port = d.source_port;
+                            packet.received_port = d.destination_port;
+                            packet.bytes.assign(d.payload, d.payload + d.payload_size);
+                            out.num_records += detail::native::write_packet(out.bytes, packet, cache);
+                            if(!detail::osc::for_each_message(d.payload, d.payload_size, [](const detail::osc::message_view &) {})) ++out.num_broken;
+                            continue;
+                        }
+                        // messages before broken part are recorded
+                        auto valid = detail::osc::for_each_message(d.payload, d.payload_size, [&](const detail::osc::message_view &m) {
+                            detail::native::write_record(out.bytes, offset_ns, m, host, d.source_port, d.destination_port, cache);
+                            ++out.num_records;
+                        });
+                        if(!valid) ++out.num_broken;
+                    }
+                });
+                for(auto &p : parts) {
+                    if(raw_packets) writer.appendPackets(p.bytes.data(), p.bytes.size(), p.num_records);
+                    else writer.append(p.bytes.data(), p.bytes.size(), p.num_records);
+                    result.num_datagrams += p.num_datagrams;
+                    result.num_skipped += p.num_skipped;
+                    result.num_fragmented += p.num_fragmented;
+                    result.num_truncated += p.num_truncated;
+                    result.num_broken += p.num_broken;
+                }
+                result.num_frames += frames.size();
+            }
+        }; // struct PcapIngest
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscPcapIngest = ofx::RecordOsc::PcapIngest;
+using ofxRecordOscIngestResult = ofx::RecordOsc::IngestResult;
+
+#endif /* ofxRecordOscPcapIngest_h */
@@ -0,0 +1,112 @@
+//
+//  ofxRecordOscRawSocket.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscRawSocket_h
+#define ofxRecordOscRawSocket_h
+
+// sockets of oscpack bundled with ofxOsc
+#include "UdpSocket.h"
+#include "PacketListener.h"
+
+#include "ofLog.h"
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <memory>
+#include <map>
+#include <functional>
+
+namespace ofx {
+    namespace RecordOsc {
+        namespace detail {
+            // receives datagrams of port on own thread and passes bytes without parsing
+            struct raw_receiver : ::osc::PacketListener {
+                // data, size, remote host, remote port. host and data are valid only while calling
+                using callback_t = std::function<void(const std::uint8_t *, std::size_t, const std::string &, std::uint16_t)>;
+
+                raw_receiver() = default;
+                raw_receiver(const raw_receiver &) = delete;
+                raw_receiver &operator=(const raw_receiver &) = delete;
+
+                ~raw_receiver()
+                { stop(); };
+
+                bool setup(std::uint16_t port, callback_t callback) {
+                    stop();
+                    try {
+                        socket.reset(new ::osc::UdpListeningReceiveSocket(::osc::IpEndpointName(::osc::IpEndpointName::ANY_ADDRESS, port), this));
+                    } catch(const std::exception &e) {
+                        ofLogError("ofxOscRecorder") << "can't listen port " << port << ": " << e.what();
+                        socket.reset();
+                        return false;
+                    }
+                    this->callback = callback;
+                    thread = std::thread([this, port] {
+#ifdef TARGET_OSX
+                        pthread_setname_np(("oscrec-raw-" + std::to_string(port)).c_str());
+#endif
+                        try {
+                            socket->Run();
+                        } catch(const std::exception &e) {
+                            ofLogError("ofxOscRecorder") << "receiving of port " << port << " is stopped: " << e.what();
+                        }
+                    });
+                    return true;
+                }
+
+                void stop() {
+                    if(!socket) return;
+                    socket->AsynchronousBreak();
+                    if(thread.joinable()) thread.join();
+                    socket.reset();
+                }
+
+                void ProcessPacket(const char *data, int size, const ::osc::IpEndpointName &remote) override {
+                    if(size <= 0) return;
+                    char address[::osc::IpEndpointName::ADDRESS_STRING_LENGTH];
+                    remote.AddressAsString(address);
+                    host.assign(address);
+                    callback(reinterpret_cast<const std::uint8_t *>(data),
+                             static_cast<std::size_t>(size),
+                             host,
+                             static_cast<std::uint16_t>(remote.port));
+                }
+
+            private:
+                std::unique_ptr<::osc::UdpListeningReceiveSocket> socket;
+                std::thread thread;
+                callback_t callback;
+                std::string host; // only touched by receiving thread
+            }; // struct raw_receiver
+
+            // sends bytes as is. sockets are cached per destination
+            struct raw_sender {
+                bool send(const std::string &host,
+                          std::uint16_t port,
+                          const std::uint8_t *data,
+                          std::size_t size)
+                {
+                    auto &&socket = sockets[std::make_pair(host, port)];
+                    try {
+                        if(!socket) socket = std::make_shared<::osc::UdpTransmitSocket>(::osc::IpEndpointName(host.c_str(), port));
+                        socket->Send(reinterpret_cast<const char *>(data), size);
+                    } catch(const std::exception &e) {
+                        ofLogWarning("ofxRecordOsc") << "can't send packet to " << host << ":" << port << ": " << e.what();
+                        socket.reset();
+                        return false;
+                    }
+                    return true;
+                }
+
+            private:
+                std::map<std::pair<std::string, std::uint16_t>, std::shared_ptr<::osc::UdpTransmitSocket>> sockets;
+            }; // struct raw_sender
+        }; // namespace detail
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+#endif /* ofxRecordOscRawSocket_h */
@@ -0,0 +1,188 @@
+//
+//  ofxRecordOscRingBuffer.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscRingBuffer_h
+#define ofxRecordOscRingBuffer_h
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace ofx {
+    namespace RecordOsc {
+        // bounded lock-free multi-producer / multi-consumer queue.
+        // all slots are allocated on construction, push / pop never allocate by itself.
+        // (based on Dmitry Vyukov's bounded MPMC queue)
+        template <typename value_type>
+        struct RingBuffer {
+            RingBuffer(std::size_t capacity = 65536)
+            { resize(capacity); };
+
+            RingBuffer(const RingBuffer &) = delete;
+            RingBuffer &operator=(const RingBuffer &) = delete;
+
+            // not thread safe. call before start using.
+            void resize(std::size_t capacity) {
+                std::size_t size = 2;
+                while(size < capacity) size <<= 1;
+                mask = size - 1;
+                cells.reset(new cell[size]);
+                for(std::size_t i = 0; i < size; ++i) {
+                    cells[i].sequence.store(i, std::memory_order_relaxed);
+                }
+                enqueue_pos.store(0, std::memory_order_relaxed);
+                dequeue_pos.store(0, std::memory_order_relaxed);
+            }
+
+            // ticket is the position of pushed value. it is monotonic and has no gap.
+            template <typename input_type>
+            bool push(input_type &&value, std::uint64_t &ticket) {
+                return pushWith([&value](value_type &slot) {
+                    slot = std::forward<input_type>(value);
+                }, ticket);
+            }
+
+            // writes value in place by write(value_type &) instead of moving value into slot.
+            // slots are reused, so buffers which value keeps (e.g. capacity of vector) are not reallocated.
+            // write is called only if queue is not full, ticket is already set then.
+            template <typename writer_t>
+            bool pushWith(writer_t write, std::uint64_t &ticket) {
+                cell *c;
+                auto pos = claim(enqueue_pos, 0, c);
+                if(c == nullptr) return false; // full
+                ticket = pos;
+                write(c->value);
+                c->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            template <typename input_type>
+            bool push(input_type &&value) {
+                std::uint64_t ticket;
+                return push(std::forward<input_type>(value), ticket);
+            }
+
+            // ticket is same value as given by push
+            bool pop(value_type &value, std::uint64_t &ticket) {
+                return popWith([&value](value_type &slot) {
+                    value = std::move(slot);
+                }, ticket);
+            }
+
+            // reads value in place by read(value_type &). value is kept in slot for reuse.
+            // ticket is already set when read is called
+            template <typename reader_t>
+            bool popWith(reader_t read, std::uint64_t &ticket) {
+                cell *c;
+                auto pos = claim(dequeue_pos, 1, c);
+                if(c == nullptr) return false; // empty
+                ticket = pos;
+                read(c->value);
+                c->sequence.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+
+            // not thread safe. e.g. reserves buffers of all slots before start using
+            template <typename function_t>
+            void forEachSlot(function_t f) {
+                for(std::size_t i = 0; i <= mask; ++i) f(cells[i].value);
+            }
+
+            bool pop(value_type &value) {
+                std::uint64_t ticket;
+                return pop(value, ticket);
+            }
+
+            std::size_t size() const {
+                auto enq = enqueue_pos.load(std::memory_order_acquire);
+                auto deq = dequeue_pos.load(std::memory_order_acquire);
+                return deq < enq ? static_cast<std::size_t>(enq - deq) : 0;
+            }
+
+            bool empty() const
+            { return size() == 0; };
+
+            std::size_t capacity() const
+            { return mask + 1; };
+
+            // total number of pushed values
+            std::uint64_t numPushed() const
+            { return enqueue_pos.load(std::memory_order_acquire); };
+
+        private:
+            struct cell {
+                std::atomic<std::uint64_t> sequence;
+                value_type value;
+            };
+
+            static constexpr std::size_t cacheline_size = 64;
+
+            // takes position from enqueue_pos (lag 0) or dequeue_pos (lag 1). c is nullptr if full / empty
+            std::uint64_t claim(std::atomic<std::uint64_t> &position, std::uint64_t lag, cell *&c) {
+                std::uint64_t pos = position.load(std::memory_order_relaxed);
+                while(true) {
+                    c = &cells[pos & mask];
+                    std::uint64_t seq = c->sequence.load(std::memory_order_acquire);
+                    auto diff = static_cast<std::int64_t>(seq) - static_cast<std::int64_t>(pos + lag);
+                    if(diff == 0) {
+                        if(position.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) return pos;
+                    } else if(diff < 0) {
+                        c = nullptr;
+                        return pos;
+                    } else {
+                        pos = position.load(std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            std::unique_ptr<cell[]> cells;
+            std::size_t mask{0};
+            alignas(cacheline_size) std::atomic<std::uint64_t> enqueue_pos{0};
+            alignas(cacheline_size) std::atomic<std::uint64_t> dequeue_pos{0};
+        }; // struct RingBuffer
+
+        // blocking wakeup for consumers of RingBuffer.
+        // producers pay only an atomic load when nobody is sleeping.
+        struct WakeupSignal {
+            void notify() {
+                if(num_waiting.load() == 0) return;
+                {
+                    auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                }
+                condition.notify_one();
+            }
+
+            void notifyAll() {
+                {
+                    auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                }
+                condition.notify_all();
+            }
+
+            // returns when predicate is true, notified or timeout
+            template <typename predicate_t, typename rep, typename period>
+            void wait(predicate_t predicate,
+                      const std::chrono::duration<rep, period> &timeout)
+            {
+                std::unique_lock<decltype(mutex)> lock(mutex);
+                ++num_waiting;
+                condition.wait_for(lock, timeout, predicate);
+                --num_waiting;
+            }
+
+        private:
+            std::mutex mutex;
+            std::condition_variable condition;
+            std::atomic<std::size_t> num_waiting{0};
+        }; // struct WakeupSignal
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+#endif /* ofxRecordOscRingBuffer_h */
@@ -0,0 +1,626 @@
+//
+//  ofxRecordOscSequenceReader.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscSequenceReader_h
+#define ofxRecordOscSequenceReader_h
+
+#include "ofxRecordOscData.h"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// SAX interface of nlohmann::json (sax_parse with binary_t) is available since 3.8.0
+#if defined(NLOHMANN_JSON_VERSION_MAJOR) && (3 < NLOHMANN_JSON_VERSION_MAJOR || (NLOHMANN_JSON_VERSION_MAJOR == 3 && 8 <= NLOHMANN_JSON_VERSION_MINOR))
+#   define OFX_RECORD_OSC_HAS_JSON_SAX 1
+#endif
+
+namespace ofx {
+    namespace RecordOsc {
+        namespace detail {
+            namespace sax {
+#ifdef OFX_RECORD_OSC_HAS_JSON_SAX
+                // scalar token of SAX event
+                struct scalar {
+                    enum class kind : std::uint8_t {
+                        null,
+                        boolean,
+                        integer,
+                        unsigned_integer,
+                        floating,
+                        string,
+                        binary
+                    };
+                    kind type{kind::null};
+                    std::int64_t i{0};
+                    std::uint64_t u{0};
+                    double d{0.0};
+                    std::string *s{nullptr};
+                    const std::vector<std::uint8_t> *bytes{nullptr};
+
+                    std::int64_t as_int64() const {
+                        switch(type) {
+                            case kind::boolean:
+                            case kind::integer:          return i;
+                            case kind::unsigned_integer: return static_cast<std::int64_t>(u);
+                            case kind::floating:         return static_cast<std::int64_t>(d);
+                            default:                     return 0;
+                        }
+                    }
+
+                    std::uint64_t as_uint64() const {
+                        switch(type) {
+                            case kind::boolean:
+                            case kind::integer:          return static_cast<std::uint64_t>(i);
+                            case kind::unsigned_integer: return u;
+                            case kind::floating:         return static_cast<std::uint64_t>(d);
+                            default:                     return 0;
+                        }
+                    }
+
+                    double as_double() const {
+                        switch(type) {
+                            case kind::boolean:
+                            case kind::integer:          return static_cast<double>(i);
+                            case kind::unsigned_integer: return static_cast<double>(u);
+                            case kind::floating:         return d;
+                            default:                     return 0.0;
+                        }
+                    }
+
+                    const std::string &as_string() const {
+                        static const std::string empty;
+                        return s ? *s : empty;
+                    }
+
+                    ofJson to_json() const {
+                        switch(type) {
+                            case kind::boolean:          return ofJson(i != 0);
+                            case kind::integer:          return ofJson(i);
+                            case kind::unsigned_integer: return ofJson(u);
+                            case kind::floating:         return ofJson(d);
+                            case kind::string:           return ofJson(std::move(*s));
+                            case kind::binary:           return ofJson::binary(*bytes);
+                            default:                     return ofJson();
+                        }
+                    }
+                };
+
+                // builds small DOM from events. used only for metadata
+                struct dom_builder {
+                    ofJson root;
+
+                    bool empty() const
+                    { return stack.empty(); };
+
+                    void key(std::string &k)
+                    { pending_key = std::move(k); };
+
+                    void value(ofJson &&v)
+                    { put(std::move(v)); };
+
+                    void start(ofJson &&container)
+                    { stack.push_back(put(std::move(container))); };
+
+                    void end()
+                    { stack.pop_back(); };
+
+                private:
+                    std::vector<ofJson *> stack;
+                    std::string pending_key;
+
+                    // pointers in stack stay valid: a container gets new element only after its children are closed
+                    ofJson *put(ofJson &&v) {
+                        if(stack.empty()) {
+                            root = std::move(v);
+                            return &root;
+                        }
+                        auto &parent = *stack.back();
+                        if(parent.is_array()) {
+                            parent.push_back(std::move(v));
+                            return &parent.back();
+                        }
+                        auto &slot = parent[pending_key];
+                        slot = std::move(v);
+                        return &slot;
+                    }
+                };
+
+                // decodes {"metadata": {...}, "sequence": [[offset, message, offset_ns, timetag], ...]}
+                // into SequenceData record by record without DOM of sequence.
+                // callback: void(SequenceData &), record can be moved from.
+                template <typename callback_t>
+                struct sequence_handler {
+                    using string_t = ofJson::string_t;
+                    using binary_t = ofJson::binary_t;
+
+                    sequence_handler(callback_t &callback)
+                    : callback(callback) {};
+
+                    ofJson metadata;
+                    bool has_metadata{false};
+                    std::uint64_t num_records{0};
+                    std::string error;
+
+#pragma mark SAX interface
+                    bool null()
+                    { return on_scalar(scalar{}); };
+
+                    bool boolean(bool value) {
+                        scalar v;
+                        v.type = scalar::kind::boolean;
+                        v.i = value ? 1 : 0;
+                        return on_scalar(v);
+                    }
+
+                    bool number_integer(ofJson::number_integer_t value) {
+                        scalar v;
+                        v.type = scalar::kind::integer;
+                        v.i = value;
+                        return on_scalar(v);
+                    }
+
+                    bool number_unsigned(ofJson::number_unsigned_t value) {
+                        scalar v;
+                        v.type = scalar::kind::unsigned_integer;
+                        v.u = value;
+                        return on_scalar(v);
+                    }
+
+                    bool number_float(ofJson::number_float_t value, const string_t &) {
+                        scalar v;
+                        v.type = scalar::kind::floating;
+                        v.d = value;
+                        return on_scalar(v);
+                    }
+
+                    bool string(string_t &value) {
+                        scalar v;
+                        v.type = scalar::kind::string;
+                        v.s = &value;
+                        return on_scalar(v);
+                    }
+
+                    // blob of Bson, CBOR and MessagePack
+                    bool binary(binary_t &value) {
+                        scalar v;
+                        v.type = scalar::kind::binary;
+                        v.bytes = &value;
+                        return on_scalar(v);
+                    }
+
+                    bool start_object(std::size_t) {
+                        if(skipping()) return ++skip_depth, true;
+                        if(!meta.empty()) return meta.start(ofJson::object()), true;
+                        switch(where) {
+                            case state::top:
+                                where = state::root;
+                                return true;
+                            case state::root:
+                                if(root_key == key_t::metadata) {
+                                    meta.start(ofJson::object());
+                                    return true;
+                                }
+                                break;
+                            case state::record:
+                                if(record_index == 1) {
+                                    where = state::message;
+                                    return true;
+                                }
+                                break;
+                            case state::args:
+                                // {"base64": "..."} of Json
+                                if(arg_index % 2 == 1 && arg_type == OFXOSC_TYPE_BLOB) {
+                                    where = state::blob_object;
+                                    blob_bytes.clear();
+                                    return true;
+                                }
+                                break;
+                            default: break;
+                        }
+                        return skip();
+                    }
+
+                    bool key(string_t &k) {
+                        if(skipping()) return true;
+                        if(!meta.empty()) return meta.key(k), true;
+                        if(where == state::root) {
+                            root_key = k == "sequence" ? key_t::sequence
+                                     : k == "metadata" ? key_t::metadata
+                                     : key_t::other;
+                        } else if(where == state::blob_object) {
+                            is_base64_key = k == detail::base64_key;
+                        } else if(where == state::message) {
+                            message_key = k == "address"       ? key_t::address
+                                        : k == "host"          ? key_t::host
+                                        : k == "port"          ? key_t::port
+                                        : k == "received_port" ? key_t::received_port
+                                        : k == "args"          ? key_t::args
+                                        : key_t::other;
+                        }
+                        return true;
+                    }
+
+                    bool end_object() {
+                        if(skipping()) return --skip_depth, true;
+                        if(!meta.empty()) {
+                            meta.end();
+                            if(meta.empty()) {
+                                metadata = std::move(meta.root);
+                                has_metadata = true;
+                            }
+                            return true;
+                        }
+                        if(where == state::blob_object) {
+                            add_blob();
+                        } else if(where == state::message) {
+                            data.mess.setRemoteEndpoint(host, port);
+                            where = state::record;
+                            ++record_index;
+                        } else if(where == state::root) {
+                            where = state::done;
+                        }
+                        return true;
+                    }
+
+                    bool start_array(std::size_t) {
+                        if(skipping()) return ++skip_depth, true;
+                        if(!meta.empty()) return meta.start(ofJson::array()), true;
+                        switch(where) {
+                            case state::root:
+                                if(root_key == key_t::sequence) {
+                                    where = state::sequence;
+                                    return true;
+                                }
+                                break;
+                            case state::sequence:
+                                begin_record();
+                                where = state::record;
+                                return true;
+                            case state::message:
+                                if(message_key == key_t::args) {
+                                    where = state::args;
+                                    arg_index = 0;
+                                    return true;
+                                }
+                                break;
+                            case state::args:
+                                if(arg_index % 2 == 1 && arg_type == OFXOSC_TYPE_INT64) {
+                                    where = state::int64_arg;
+                                    int64_index = 0;
+                                    return true;
+                                }
+                                // array of uint8 of UBJson
+                                if(arg_index % 2 == 1 && arg_type == OFXOSC_TYPE_BLOB) {
+                                    where = state::blob_array;
+                                    blob_bytes.clear();
+                                    return true;
+                                }
+                                break;
+                            default: break;
+                        }
+                        return skip();
+                    }
+
+                    bool end_array() {
+                        if(skipping()) return --skip_depth, true;
+                        if(!meta.empty()) {
+                            meta.end();
+                            return true;
+                        }
+                        switch(where) {
+                            case state::sequence:
+                                where = state::root;
+                                break;
+                            case state::record:
+                                end_record();
+                                where = state::sequence;
+                                break;
+                            case state::args:
+                                where = state::message;
+                                break;
+                            case state::int64_arg:
+                                data.mess.add(int64_value.value);
+                                where = state::args;
+                                ++arg_index;
+                                break;
+                            case state::blob_array:
+                                add_blob();
+                                break;
+                            default: break;
+                        }
+                        return true;
+                    }
+
+                    bool parse_error(std::size_t position,
+                                     const std::string &,
+                                     const std::exception &e)
+                    {
+                        error = e.what();
+                        ofLogError("ofxRecordOsc") << "parse error at " << position << ": " << error;
+                        return false;
+                    }
+
+                private:
+                    enum class state : std::uint8_t {
+                        top,
+                        root,
+                        sequence,
+                        record,
+                        message,
+                        args,
+                        int64_arg,
+                        blob_object,
+                        blob_array,
+                        done
+                    };
+                    enum class key_t : std::uint8_t {
+                        other,
+                        sequence,
+                        metadata,
+                        address,
+                        host,
+                        port,
+                        received_port,
+                        args
+                    };
+
+                    callback_t &callback;
+                    state where{state::top};
+                    key_t root_key{key_t::other};
+                    key_t message_key{key_t::other};
+                    std::size_t skip_depth{0};
+                    dom_builder meta;
+
+                    SequenceData data;
+                    std::size_t record_index{0};
+                    double offset{0.0};
+                    std::int64_t offset_ns{0};
+                    std::string host;
+                    std::uint16_t port{0};
+                    std::size_t arg_index{0};
+                    ofxOscArgType arg_type{OFXOSC_TYPE_NONE};
+                    detail::int64_serializer int64_value;
+                    std::size_t int64_index{0};
+                    std::vector<std::uint8_t> blob_bytes;
+                    bool is_base64_key{false};
+
+                    bool skipping() const
+                    { return 0 < skip_depth; };
+
+                    // unknown container is passed over
+                    bool skip() {
+                        skip_depth = 1;
+                        return true;
+                    }
+
+                    void begin_record() {
+                        data.mess.clear();
+                        data.timetag = 0;
+                        data.address_id = SequenceData::unknown_address_id;
+                        record_index = 0;
+                        offset = 0.0;
+                        offset_ns = 0;
+                        host.clear();
+                        port = 0;
+                    }
+
+                    void end_record() {
+                        // [offset, message] or [offset, message, offset_ns, timetag]
+                        if(2 < record_index) data.setOffsetNanos(offset_ns);
+                        else data.setOffset(offset);
+                        data.sequence = num_records++;
+                        callback(data);
+                    }
+
+                    bool on_scalar(const scalar &v) {
+                        if(skipping()) return true;
+                        if(!meta.empty()) return meta.value(v.to_json()), true;
+                        switch(where) {
+                            case state::record:
+                                switch(record_index++) {
+                                    case 0: offset = v.as_double(); break;
+                                    case 2: offset_ns = v.as_int64(); break;
+                                    case 3: data.timetag = v.as_uint64(); break;
+                                    default: break;
+                                }
+                                break;
+                            case state::message:
+                                switch(message_key) {
+                                    case key_t::address:       data.mess.setAddress(v.as_string()); break;
+                                    case key_t::host:          host = v.as_string(); break;
+                                    case key_t::port:          port = static_cast<std::uint16_t>(v.as_uint64()); break;
+                                    case key_t::received_port: data.mess.setWaitingPort(static_cast<std::uint16_t>(v.as_uint64())); break;
+                                    default: break;
+                                }
+                                break;
+                            case state::args:
+                                if(arg_index++ % 2 == 0) arg_type = static_cast<ofxOscArgType>(v.as_int64());
+                                else add_arg(v);
+                                break;
+                            case state::blob_object:
+                                if(is_base64_key) blob_bytes = detail::base64_decode(v.as_string());
+                                break;
+                            case state::blob_array:
+                                blob_bytes.push_back(static_cast<std::uint8_t>(v.as_uint64()));
+                                break;
+                            case state::int64_arg:
+                                if(int64_index == 0) int64_value.upper = static_cast<std::uint32_t>(v.as_uint64());
+                                else if(int64_index == 1) int64_value.lower = static_cast<std::uint32_t>(v.as_uint64());
+                                ++int64_index;
+                                break;
+                            default: break;
+                        }
+                        return true;
+                    }
+
+                    void add_blob() {
+                        data.mess.addBlobArg(ofBuffer{reinterpret_cast<const char *>(blob_bytes.data()), blob_bytes.size()});
+                        where = state::args;
+                        ++arg_index;
+                    }
+
+                    // same as from_json of ofxOscMessageEx
+                    void add_arg(const scalar &v) {
+                        auto &mess = data.mess;
+                        switch(arg_type) {
+                            case OFXOSC_TYPE_INT32:
+                                mess.add(static_cast<std::int32_t>(v.as_int64()));
+                                break;
+                            case OFXOSC_TYPE_CHAR:
+                                mess.add(static_cast<char>(v.as_int64()));
+                                break;
+                            case OFXOSC_TYPE_INT64:
+                                // [upper, lower] is handled as array
+                                mess.add(v.as_int64());
+                                break;
+                            case OFXOSC_TYPE_FLOAT:
+                                mess.add(static_cast<float>(v.as_double()));
+                                break;
+                            case OFXOSC_TYPE_DOUBLE:
+                                mess.add(v.as_double());
+                                break;
+                            case OFXOSC_TYPE_STRING:
+                            case OFXOSC_TYPE_SYMBOL:
+                                mess.add(v.as_string());
+                                break;
+                            case OFXOSC_TYPE_MIDI_MESSAGE:
+                                mess.addMidiMessageArg(static_cast<std::uint32_t>(v.as_uint64()));
+                                break;
+                            case OFXOSC_TYPE_TRUE:
+                                mess.add(true);
+                                break;
+                            case OFXOSC_TYPE_FALSE:
+                                mess.add(false);
+                                break;
+                            case OFXOSC_TYPE_TIMETAG:
+                                mess.addTimetagArg(v.as_uint64());
+                                break;
+                            case OFXOSC_TYPE_BLOB: {
+                                if(v.type == scalar::kind::binary) {
+                                    mess.addBlobArg(ofBuffer{reinterpret_cast<const char *>(v.bytes->data()), v.bytes->size()});
+                                    break;
+                                }
+                                // written by old version
+                                auto &&str = v.as_string();
+                                mess.addBlobArg(ofBuffer{str.c_str(), str.length()});
+                                break;
+                            }
+                            case OFXOSC_TYPE_RGBA_COLOR:
+                                mess.addTimetagArg(static_cast<std::uint32_t>(v.as_uint64()));
+                                break;
+                            case OFXOSC_TYPE_NONE:
+                                mess.addNoneArg();
+                                break;
+                            case OFXOSC_TYPE_TRIGGER:
+                                mess.addTriggerArg();
+                                break;
+                            case OFXOSC_TYPE_INDEXOUTOFBOUNDS:
+                                break;
+                        }
+                    }
+                }; // struct sequence_handler
+
+                inline bool to_input_format(FileFormat format, ofJson::input_format_t &input_format) {
+                    switch(format) {
+                        case FileFormat::Json:        input_format = ofJson::input_format_t::json;    return true;
+                        case FileFormat::Bson:        input_format = ofJson::input_format_t::bson;    return true;
+                        case FileFormat::CBOR:        input_format = ofJson::input_format_t::cbor;    return true;
+                        case FileFormat::MessagePack: input_format = ofJson::input_format_t::msgpack; return true;
+                        case FileFormat::UBJson:      input_format = ofJson::input_format_t::ubjson;  return true;
+                        default:                      return false;
+                    }
+                }
+#endif
+            }; // namespace sax
+        }; // namespace detail
+
+        // reads recording of any FileFormat record by record.
+        // Json / Bson / CBOR / MessagePack / UBJson are decoded from tokens (SAX),
+        // so DOM of whole recording is never built. only bytes of file and metadata are kept while reading.
+        struct SequenceReader {
+            // callback: void(SequenceData &). record can be moved from.
+            template <typename callback_t>
+            bool read(const std::string &filepath,
+                      FileFormat format,
+                      callback_t callback)
+            {
+                num_records = 0;
+                meta = Metadata{};
+                auto &&path = ofToDataPath(filepath, true);
+                if(format == FileFormat::Native) {
+                    NativeReader reader;
+                    auto succeeded = reader.read(path, [&](const SequenceData &data) {
+                        SequenceData copied = data;
+                        callback(copied);
+                    });
+                    num_records = reader.numRecords();
+                    meta = reader.metadata();
+                    return succeeded;
+                }
+#ifdef OFX_RECORD_OSC_HAS_JSON_SAX
+                ofJson::input_format_t input_format;
+                if(!detail::sax::to_input_format(format, input_format)) {
+                    ofLogWarning("ofxRecordOsc") << "unknown file format: " << (int)format << ". file will be read as JSON format.";
+                    input_format = ofJson::input_format_t::json;
+                }
+                std::vector<std::uint8_t> binary;
+                if(!detail::load_binary(path, binary)) return false;
+                detail::sax::sequence_handler<callback_t> handler{callback};
+                bool succeeded = false;
+                try {
+                    succeeded = ofJson::sax_parse(binary, &handler, input_format);
+                    if(handler.has_metadata) meta = handler.metadata;
+                    else ofLogWarning("ofxRecordOsc") << filepath << " has no metadata.";
+                } catch(const std::exception &e) {
+                    ofLogError("ofxRecordOsc") << "can't read " << filepath << ": " << e.what();
+                    succeeded = false;
+                }
+                num_records = handler.num_records;
+                return succeeded;
+#else
+                // old nlohmann::json has no SAX interface
+                try {
+                    auto &&json = detail::load(filepath, format);
+                    for(const auto &record : json["sequence"]) {
+                        SequenceData data = record;
+                        data.sequence = num_records++;
+                        callback(data);
+                    }
+                    meta = json["metadata"];
+                } catch(const std::exception &e) {
+                    ofLogError("ofxRecordOsc") << "can't read " << filepath << ": " << e.what();
+                    return false;
+                }
+                return true;
+#endif
+            }
+
+            bool read(const std::string &filepath,
+                      FileFormat format,
+                      std::vector<SequenceData> &sequence)
+            {
+                return read(filepath, format, [&sequence](SequenceData &data) {
+                    sequence.push_back(std::move(data));
+                });
+            }
+
+            const Metadata &metadata() const
+            { return meta; };
+
+            std::uint64_t numRecords() const
+            { return num_records; };
+
+        private:
+            Metadata meta;
+            std::uint64_t num_records{0};
+        }; // struct SequenceReader
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscSequenceReader = ofx::RecordOsc::SequenceReader;
+
+#endif /* ofxRecordOscSequenceReader_h */
@@ -0,0 +1,132 @@
+//
+//  ofxRecordOscSession.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscSession_h
+#define ofxRecordOscSession_h
+
+#include "ofxRecordOscData.h"
+
+#include "ofFileUtils.h"
+#include "ofJson.h"
+
+#include <cstdio>
+
+namespace ofx {
+    namespace RecordOsc {
+        // a file of recording split by rotation
+        struct SegmentInfo {
+            std::string filename; // relative to session directory
+            std::uint64_t num_records{0};
+            std::int64_t first_offset_ns{0};
+            std::int64_t last_offset_ns{0};
+            // false while recording or if recorder was crashed
+            bool finalized{false};
+
+            friend
+            inline void to_json(ofJson &j, const SegmentInfo &segment) {
+                j["filename"]        = segment.filename;
+                j["num_records"]     = segment.num_records;
+                j["first_offset_ns"] = segment.first_offset_ns;
+                j["last_offset_ns"]  = segment.last_offset_ns;
+                j["finalized"]       = segment.finalized;
+            }
+
+            friend
+            inline void from_json(const ofJson &j, SegmentInfo &segment) {
+                segment.filename        = j["filename"].get<std::string>();
+                segment.num_records     = j["num_records"];
+                segment.first_offset_ns = j["first_offset_ns"];
+                segment.last_offset_ns  = j["last_offset_ns"];
+                segment.finalized       = j["finalized"];
+            }
+        }; // struct SegmentInfo
+
+        // manifest.json in session directory.
+        // offsets of all segments are relative to start of session, so segments make one timeline.
+        struct SessionManifest {
+            static std::string manifestFilename()
+            { return "manifest.json"; };
+
+            static std::string segmentFilename(std::size_t index)
+            { return ofVAArgsToString("segment-%05d.", static_cast<int>(index)) + detail::to_ext(FileFormat::Native); };
+
+            std::uint32_t version{1};
+            Metadata metadata;
+            std::vector<SegmentInfo> segments;
+            // false while recording or if recorder was crashed
+            bool finalized{false};
+
+            // manifest is replaced atomically, so crashed session always has valid manifest
+            bool save(const std::string &session_directory) const {
+                auto &&path = ofFilePath::join(session_directory, manifestFilename());
+                auto &&temporary_path = path + ".tmp";
+                if(!ofSavePrettyJson(temporary_path, *this)) {
+                    ofLogError("ofxRecordOsc") << "can't save manifest: " << temporary_path;
+                    return false;
+                }
+#ifdef TARGET_WIN32
+                // rename of std doesn't replace existing file on windows
+                return MoveFileExA(temporary_path.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+                // rename replaces existing file atomically on POSIX
+                return std::rename(temporary_path.c_str(), path.c_str()) == 0;
+#endif
+            }
+
+            // path is session directory or manifest file
+            bool load(const std::string &path) {
+                auto &&manifest_path = ofDirectory::doesDirectoryExist(path, false)
+                                     ? ofFilePath::join(path, manifestFilename())
+                                     : path;
+                auto &&json = ofLoadJson(manifest_path);
+                if(!json.is_object() || json.find("segments") == json.end()) {
+                    ofLogError("ofxRecordOsc") << "can't load manifest: " << manifest_path;
+                    return false;
+                }
+                *this = json.get<SessionManifest>();
+                directory = ofFilePath::getEnclosingDirectory(manifest_path, false);
+                return true;
+            }
+
+            // directory of loaded manifest
+            const std::string &sessionDirectory() const
+            { return directory; };
+
+            std::string segmentPath(std::size_t index) const
+            { return ofFilePath::join(directory, segments[index].filename); };
+
+            std::uint64_t numRecords() const {
+                std::uint64_t num = 0;
+                for(const auto &segment : segments) num += segment.num_records;
+                return num;
+            }
+
+            friend
+            inline void to_json(ofJson &j, const SessionManifest &manifest) {
+                j["version"]   = manifest.version;
+                j["metadata"]  = manifest.metadata;
+                j["segments"]  = manifest.segments;
+                j["finalized"] = manifest.finalized;
+            }
+
+            friend
+            inline void from_json(const ofJson &j, SessionManifest &manifest) {
+                manifest.version   = j["version"];
+                manifest.metadata  = j["metadata"];
+                manifest.segments  = j["segments"].get<decltype(manifest.segments)>();
+                manifest.finalized = j["finalized"];
+            }
+
+        private:
+            std::string directory;
+        }; // struct SessionManifest
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscSegmentInfo = ofx::RecordOsc::SegmentInfo;
+using ofxRecordOscSessionManifest = ofx::RecordOsc::SessionManifest;
+
+#endif /* ofxRecordOscSession_h */
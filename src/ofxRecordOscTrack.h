@@ -0,0 +1,279 @@
+//
+//  ofxRecordOscTrack.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordOscTrack_h
+#define ofxRecordOscTrack_h
+
+#include "ofxRecordOscNativeFormat.h"
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+
+// columnar file (.osccol). all values are little endian, all arrays are aligned by 8 bytes.
+//
+//   header : magic "OSCC", version u32, num_tracks u32, reserved u32
+//   track  : address_length u32, num_columns u32, num_rows u64,
+//            address (padded to multiple of 8),
+//            offsets f64[num_rows] (sec),
+//            column 0 f64[num_rows], column 1 f64[num_rows], ...
+
+namespace ofx {
+    namespace RecordOsc {
+        struct ColumnStats {
+            double min{std::numeric_limits<double>::quiet_NaN()};
+            double max{std::numeric_limits<double>::quiet_NaN()};
+            double mean{std::numeric_limits<double>::quiet_NaN()};
+            std::size_t count{0}; // number of values except NaN
+        };
+
+        namespace detail {
+            // independent accumulators per lane, so compiler can vectorize
+            // without reordering of floating point operations.
+            // NaN is skipped: comparison with NaN is always false.
+            inline ColumnStats compute_stats(const double *values, std::size_t size) {
+                constexpr std::size_t lanes = 8;
+                constexpr double inf = std::numeric_limits<double>::infinity();
+                double mins[lanes], maxs[lanes], sums[lanes], counts[lanes];
+                for(std::size_t j = 0; j < lanes; ++j) {
+                    mins[j] = inf;
+                    maxs[j] = -inf;
+                    sums[j] = 0.0;
+                    counts[j] = 0.0;
+                }
+                std::size_t i = 0;
+                for(; i + lanes <= size; i += lanes) {
+                    for(std::size_t j = 0; j < lanes; ++j) {
+                        auto v = values[i + j];
+                        bool valid = v == v;
+                        mins[j] = v < mins[j] ? v : mins[j];
+                        maxs[j] = maxs[j] < v ? v : maxs[j];
+                        sums[j] += valid ? v : 0.0;
+                        counts[j] += valid ? 1.0 : 0.0;
+                    }
+                }
+                for(std::size_t j = 0; i < size; ++i, ++j) {
+                    auto v = values[i];
+                    bool valid = v == v;
+                    mins[j] = v < mins[j] ? v : mins[j];
+                    maxs[j] = maxs[j] < v ? v : maxs[j];
+                    sums[j] += valid ? v : 0.0;
+                    counts[j] += valid ? 1.0 : 0.0;
+                }
+                ColumnStats stats;
+                double min = inf, max = -inf, sum = 0.0, count = 0.0;
+                for(std::size_t j = 0; j < lanes; ++j) {
+                    min = std::min(min, mins[j]);
+                    max = std::max(max, maxs[j]);
+                    sum += sums[j];
+                    count += counts[j];
+                }
+                stats.count = static_cast<std::size_t>(count);
+                if(stats.count == 0) return stats;
+                stats.min = min;
+                stats.max = max;
+                stats.mean = sum / count;
+                return stats;
+            }
+
+            // linear interpolation of (times, values) at from, from + interval, ...
+            // times must be sorted. outside of times is clamped to the first / last value.
+            inline void resample_linear(const double *times,
+                                        const double *values,
+                                        std::size_t size,
+                                        double from,
+                                        double interval,
+                                        std::size_t num_samples,
+                                        double *out)
+            {
+                if(size == 0) {
+                    for(std::size_t k = 0; k < num_samples; ++k) out[k] = std::numeric_limits<double>::quiet_NaN();
+                    return;
+                }
+                std::size_t i = 0;
+                for(std::size_t k = 0; k < num_samples; ++k) {
+                    double t = from + interval * k;
+                    while(i + 1 < size && times[i + 1] <= t) ++i;
+                    if(t <= times[0]) {
+                        out[k] = values[0];
+                    } else if(i + 1 == size) {
+                        out[k] = values[size - 1];
+                    } else {
+                        double span = times[i + 1] - times[i];
+                        double rate = 0.0 < span ? (t - times[i]) / span : 0.0;
+                        out[k] = values[i] + (values[i + 1] - values[i]) * rate;
+                    }
+                }
+            }
+        }; // namespace detail
+
+        // records of one address as contiguous arrays.
+        // columns[i][row] is i-th argument of row-th record, NaN if it is missing or not numeric.
+        struct Track {
+            std::string address;
+            std::vector<double> offsets; // sec
+            std::vector<std::vector<double>> columns;
+
+            std::size_t size() const
+            { return offsets.size(); };
+
+            std::size_t numColumns() const
+            { return columns.size(); };
+
+            void append(const SequenceData &data) {
+                const auto &mess = data.mess;
+                auto row = offsets.size();
+                if(columns.size() < mess.getNumArgs()) {
+                    columns.resize(mess.getNumArgs(), std::vector<double>(row, std::numeric_limits<double>::quiet_NaN()));
+                }
+                offsets.push_back(data.offset_ns / 1000000000.0);
+                for(std::size_t i = 0; i < columns.size(); ++i) {
+                    columns[i].push_back(i < mess.getNumArgs()
+                                         ? detail::arg_as_double(mess, i)
+                                         : std::numeric_limits<double>::quiet_NaN());
+                }
+            }
+
+            ColumnStats stats(std::size_t column) const {
+                if(columns.size() <= column) return {};
+                return detail::compute_stats(columns[column].data(), size());
+            }
+
+            // values of column at every interval_sec from first to last offset
+            std::vector<double> resample(std::size_t column, double interval_sec) const {
+                if(columns.size() <= column || offsets.empty() || interval_sec <= 0.0) return {};
+                return resample(column, offsets.front(), offsets.back(), interval_sec);
+            }
+
+            std::vector<double> resample(std::size_t column,
+                                         double from_sec,
+                                         double to_sec,
+                                         double interval_sec) const
+            {
+                if(columns.size() <= column || interval_sec <= 0.0 || to_sec < from_sec) return {};
+                auto num_samples = static_cast<std::size_t>(std::floor((to_sec - from_sec) / interval_sec)) + 1;
+                std::vector<double> samples(num_samples);
+                detail::resample_linear(offsets.data(),
+                                        columns[column].data(),
+                                        size(),
+                                        from_sec,
+                                        interval_sec,
+                                        num_samples,
+                                        samples.data());
+                return samples;
+            }
+        }; // struct Track
+
+        namespace detail {
+            namespace columnar {
+                constexpr std::uint32_t magic = 0x4343534F; // "OSCC"
+                constexpr std::uint32_t version = 1;
+
+                // address_length, num_columns, num_rows with empty address
+                constexpr std::size_t min_track_header_size = 16;
+
+                inline std::size_t padded(std::size_t size)
+                { return (size + 7) & ~static_cast<std::size_t>(7); };
+            }; // namespace columnar
+        }; // namespace detail
+
+        inline bool saveTracks(const std::string &filepath,
+                               const std::vector<Track> &tracks)
+        {
+            namespace columnar = detail::columnar;
+            std::FILE *fp = std::fopen(filepath.c_str(), "wb");
+            if(fp == nullptr) {
+                ofLogError("ofxRecordOsc") << "can't open file: " << filepath << " on save tracks";
+                return false;
+            }
+            std::vector<std::uint8_t> header;
+            detail::native::binary_writer writer{header};
+            writer.write_u32(columnar::magic);
+            writer.write_u32(columnar::version);
+            writer.write_u32(static_cast<std::uint32_t>(tracks.size()));
+            writer.write_u32(0);
+            bool succeeded = std::fwrite(header.data(), 1, header.size(), fp) == header.size();
+            // doubles are written as is, host must be little endian
+            auto write_array = [&](const std::vector<double> &values) {
+                if(values.empty()) return;
+                succeeded = succeeded && std::fwrite(values.data(), sizeof(double), values.size(), fp) == values.size();
+            };
+            for(const auto &track : tracks) {
+                header.clear();
+                writer.write_u32(static_cast<std::uint32_t>(track.address.length()));
+                writer.write_u32(static_cast<std::uint32_t>(track.numColumns()));
+                writer.write_u64(track.size());
+                writer.write_bytes(track.address.data(), track.address.length());
+                header.resize(columnar::padded(header.size()), 0);
+                succeeded = succeeded && std::fwrite(header.data(), 1, header.size(), fp) == header.size();
+                write_array(track.offsets);
+                for(const auto &column : track.columns) write_array(column);
+            }
+            std::fclose(fp);
+            if(!succeeded) ofLogError("ofxRecordOsc") << "can't write tracks: " << filepath;
+            return succeeded;
+        }
+
+        inline bool loadTracks(const std::string &filepath,
+                               std::vector<Track> &tracks)
+        {
+            namespace columnar = detail::columnar;
+            std::vector<std::uint8_t> data;
+            if(!detail::load_binary(filepath, data)) return false;
+            detail::native::binary_reader reader{data.data(), data.size()};
+            if(reader.read_u32() != columnar::magic || reader.read_u32() != columnar::version) {
+                ofLogError("ofxRecordOsc") << filepath << " is not columnar file of ofxRecordOsc";
+                return false;
+            }
+            auto num_tracks = reader.read_u32();
+            reader.read_u32();
+            auto read_array = [&](std::vector<double> &values, std::size_t size) {
+                auto p = reader.read_bytes(size * sizeof(double));
+                if(p == nullptr) return false;
+                values.resize(size);
+                if(size) std::memcpy(values.data(), p, size * sizeof(double));
+                return true;
+            };
+            tracks.clear();
+            // counts are not trusted until bytes for them are found
+            tracks.reserve(std::min<std::size_t>(num_tracks, reader.remaining() / columnar::min_track_header_size));
+            for(std::uint32_t n = 0; n < num_tracks; ++n) {
+                Track track;
+                auto address_length = reader.read_u32();
+                auto num_columns = reader.read_u32();
+                auto num_rows = reader.read_u64();
+                auto address = reader.read_bytes(columnar::padded(address_length));
+                if(address == nullptr) break;
+                // offsets and each column take num_rows doubles.
+                // Track::append never makes columns without rows
+                auto max_rows = reader.remaining() / sizeof(double);
+                if(max_rows < num_rows) break;
+                if(num_rows == 0 ? num_columns != 0 : max_rows / num_rows < num_columns + 1ull) break;
+                track.address.assign(reinterpret_cast<const char *>(address), address_length);
+                auto rows = static_cast<std::size_t>(num_rows);
+                if(!read_array(track.offsets, rows)) break;
+                track.columns.resize(num_columns);
+                bool completed = true;
+                for(auto &column : track.columns) completed = completed && read_array(column, rows);
+                if(!completed) break;
+                tracks.push_back(std::move(track));
+            }
+            if(tracks.size() != num_tracks) {
+                ofLogError("ofxRecordOsc") << filepath << " is truncated or broken. " << tracks.size() << " / " << num_tracks << " tracks are loaded.";
+                return false;
+            }
+            return true;
+        }
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordOscTrack = ofx::RecordOsc::Track;
+using ofxRecordOscColumnStats = ofx::RecordOsc::ColumnStats;
+
+#endif /* ofxRecordOscTrack_h */
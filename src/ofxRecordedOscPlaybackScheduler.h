@@ -0,0 +1,375 @@
+//
+//  ofxRecordedOscPlaybackScheduler.h
+//
+//  Created by 2bit on 2026/10/17.
+//
+
+#ifndef ofxRecordedOscPlaybackScheduler_h
+#define ofxRecordedOscPlaybackScheduler_h
+
+#include "ofxRecordedOscPlayer.h"
+#include "ofxRecordOscBundledSender.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <limits>
+#include <memory>
+
+namespace ofx {
+    namespace RecordOsc {
+        // dispatches records of Player on its own thread at exact offset
+        // against steady_clock, independent of frame rate of app.
+        struct PlaybackScheduler {
+            using clock = std::chrono::steady_clock;
+            using dispatcher_t = std::function<void(const SequenceData &)>;
+
+            struct LatencyStats {
+                std::uint64_t num_dispatched{0};
+                std::int64_t min_ns{0};
+                std::int64_t max_ns{0};
+                double mean_ns{0.0};
+            };
+
+            PlaybackScheduler() = default;
+            PlaybackScheduler(const PlaybackScheduler &) = delete;
+            PlaybackScheduler &operator=(const PlaybackScheduler &) = delete;
+            ~PlaybackScheduler()
+            { close(); };
+
+            // player must be alive while scheduler is alive
+            void setup(const Player &player) {
+                close();
+                this->player = &player;
+                media_anchor_ns = 0;
+                is_playing = false;
+                is_running = true;
+                resetLatencyStats();
+                thread = std::thread([this] {
+#ifdef TARGET_OSX
+                    pthread_setname_np("oscrec-play");
+#endif
+                    process();
+                });
+            }
+
+            void close() {
+                if(!thread.joinable()) return;
+                {
+                    auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                    is_running = false;
+                }
+                condition.notify_all();
+                thread.join();
+            }
+
+            // default dispatcher notifies to ofxPubSubOsc subscribers of waiting port
+            void setDispatcher(dispatcher_t dispatcher) {
+                {
+                    auto &&_ = std::lock_guard<decltype(dispatcher_mutex)>(dispatcher_mutex);
+                    this->dispatcher = dispatcher;
+                    bundled_sender.reset();
+                }
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                is_bundled = false;
+            }
+
+            // each message is sent by ofxSendOsc at its own time
+            void setTargetHost(const std::string &target_host) {
+                setDispatcher([target_host](const SequenceData &data) {
+                    ofxSendOsc(target_host, data.mess.getWaitingPort(), data.mess);
+                });
+            }
+
+            // messages due within bundle_window_ns are sent together at the time of the first one,
+            // as OSC bundles per received port by BundledSender (see ofxRecordOscBundledSender.h).
+            // max_datagram_size is size limit of a bundle.
+            bool setBundledTargetHost(const std::string &target_host,
+                                      std::size_t max_datagram_size = BundledSender::default_max_datagram_size)
+            {
+                std::unique_ptr<BundledSender> sender(new BundledSender);
+                if(!sender->setup(target_host)) return false;
+                sender->max_datagram_size = max_datagram_size;
+                {
+                    auto &&_ = std::lock_guard<decltype(dispatcher_mutex)>(dispatcher_mutex);
+                    bundled_sender = std::move(sender);
+                }
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                is_bundled = true;
+                return true;
+            }
+
+            // empty if target is not set by setBundledTargetHost
+            BundledSenderStats getBundledSenderStats() const {
+                auto &&_ = std::lock_guard<decltype(dispatcher_mutex)>(dispatcher_mutex);
+                return bundled_sender ? bundled_sender->getStats() : BundledSenderStats{};
+            }
+
+#pragma mark control
+
+            void play() {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                if(is_playing) return;
+                // rewinds after playback reached the end
+                if(!is_loop && player && player->durationNanos() <= media_anchor_ns) media_anchor_ns = 0;
+                wall_anchor = clock::now();
+                is_playing = true;
+                touch();
+            }
+
+            void pause() {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                if(!is_playing) return;
+                media_anchor_ns = positionNanosUnlocked();
+                is_playing = false;
+                touch();
+            }
+
+            void stop() {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                is_playing = false;
+                media_anchor_ns = 0;
+                touch();
+            }
+
+            void seek(double sec)
+            { seekNanos(std::llround(sec * 1000000000.0)); };
+
+            void seekNanos(std::int64_t position_ns) {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                media_anchor_ns = position_ns;
+                wall_anchor = clock::now();
+                touch();
+            }
+
+            void setLoop(bool loop) {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                is_loop = loop;
+                touch();
+            }
+
+            void setSpeed(double speed) {
+                if(speed <= 0.0) {
+                    ofLogWarning("ofxRecordedOscPlaybackScheduler") << "speed must be positive: " << speed;
+                    return;
+                }
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                media_anchor_ns = positionNanosUnlocked();
+                wall_anchor = clock::now();
+                this->speed = speed;
+                touch();
+            }
+
+            bool isPlaying() const {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                return is_playing;
+            }
+
+            bool isLoop() const {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                return is_loop;
+            }
+
+            double getSpeed() const {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                return speed;
+            }
+
+            double position() const
+            { return positionNanos() / 1000000000.0; };
+
+            std::int64_t positionNanos() const {
+                auto &&_ = std::lock_guard<decltype(mutex)>(mutex);
+                return positionNanosUnlocked();
+            }
+
+#pragma mark stats
+
+            // latency is measured from scheduled time to start of dispatch.
+            // records sent ahead in a bundle have negative latency
+            LatencyStats getLatencyStats() const {
+                auto &&_ = std::lock_guard<decltype(stats_mutex)>(stats_mutex);
+                return stats;
+            }
+
+            void resetLatencyStats() {
+                auto &&_ = std::lock_guard<decltype(stats_mutex)>(stats_mutex);
+                stats = LatencyStats{};
+            }
+
+            // records are fetched from player per this length of media time
+            std::int64_t window_length_ns{50 * 1000 * 1000};
+            // thread sleeps until this duration before scheduled time, then spins
+            std::int64_t spin_threshold_ns{1000 * 1000};
+            // only for setBundledTargetHost. with 0, only records overdue at dispatch are grouped
+            std::int64_t bundle_window_ns{1000 * 1000};
+
+        private:
+            const Player *player{nullptr};
+            dispatcher_t dispatcher{[](const SequenceData &data) {
+                ofxNotifyToSubscribedOsc(data.mess.getWaitingPort(), data.mess);
+            }};
+            std::unique_ptr<BundledSender> bundled_sender; // guarded by dispatcher_mutex
+            mutable std::mutex dispatcher_mutex;
+
+            mutable std::mutex mutex;
+            std::condition_variable condition;
+            std::thread thread;
+            bool is_running{false};
+            bool is_playing{false};
+            bool is_loop{false};
+            bool is_bundled{false};
+            double speed{1.0};
+            // media time media_anchor_ns is played at wall_anchor
+            std::int64_t media_anchor_ns{0};
+            clock::time_point wall_anchor;
+            // incremented when controlled. scheduled window is discarded
+            std::uint64_t generation{0};
+
+            mutable std::mutex stats_mutex;
+            LatencyStats stats;
+
+            void touch() {
+                ++generation;
+                condition.notify_all();
+            }
+
+            std::int64_t positionNanosUnlocked() const {
+                if(!is_playing) return media_anchor_ns;
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - wall_anchor).count();
+                return media_anchor_ns + static_cast<std::int64_t>(elapsed * speed);
+            }
+
+            clock::time_point scheduledTime(std::int64_t offset_ns) const {
+                auto delay = static_cast<std::int64_t>((offset_ns - media_anchor_ns) / speed);
+                return wall_anchor + std::chrono::nanoseconds(delay);
+            }
+
+            void process() {
+                // records of eager player are referred in place, so pre-encoded bytes of them are sent.
+                // records of lazy player are copied
+                std::vector<const SequenceData *> window;
+                std::vector<SequenceData> copies;
+                std::vector<clock::time_point> due_targets;
+                std::size_t cursor = 0;
+                std::int64_t fetched_until = 0;
+                std::uint64_t scheduled_generation = (std::numeric_limits<std::uint64_t>::max)();
+
+                std::unique_lock<decltype(mutex)> lock(mutex);
+                while(is_running) {
+                    if(!is_playing || player == nullptr) {
+                        condition.wait(lock);
+                        continue;
+                    }
+                    if(scheduled_generation != generation) {
+                        scheduled_generation = generation;
+                        window.clear();
+                        cursor = 0;
+                        fetched_until = media_anchor_ns;
+                    }
+
+                    if(cursor == window.size()) {
+                        auto end_ns = player->durationNanos();
+                        if(end_ns < fetched_until) {
+                            // playback reaches end when wall clock does, not when last window is fetched
+                            auto end_time = scheduledTime(end_ns);
+                            if(clock::now() < end_time) {
+                                condition.wait_until(lock, end_time);
+                                continue;
+                            }
+                            if(is_loop && 0 < end_ns) {
+                                // restart from 0 at the time of end of recording, without drift
+                                wall_anchor = end_time;
+                                media_anchor_ns = 0;
+                                touch();
+                            } else {
+                                // recording without length would be looped without waiting
+                                if(is_loop) ofLogWarning("ofxRecordedOscPlaybackScheduler") << "recording has no length to loop. playback is stopped.";
+                                media_anchor_ns = end_ns;
+                                is_playing = false;
+                            }
+                            continue;
+                        }
+                        window.clear();
+                        cursor = 0;
+                        auto from = fetched_until;
+                        auto to = fetched_until + window_length_ns - 1;
+                        lock.unlock();
+                        copies.clear();
+                        if(player->isLazy()) {
+                            player->forEachInRangeNanos(from, to, [&copies](const SequenceData &data) {
+                                copies.push_back(data);
+                            });
+                            for(const auto &data : copies) window.push_back(&data);
+                        } else {
+                            player->forEachInRangeNanos(from, to, [&window](const SequenceData &data) {
+                                window.push_back(&data);
+                            });
+                        }
+                        lock.lock();
+                        fetched_until = to + 1;
+                        continue;
+                    }
+
+                    const auto &data = *window[cursor];
+                    auto target = scheduledTime(data.offset_ns);
+                    if(std::chrono::nanoseconds(spin_threshold_ns) < target - clock::now()) {
+                        condition.wait_until(lock, target - std::chrono::nanoseconds(spin_threshold_ns));
+                        continue;
+                    }
+
+                    // records due in the same tick
+                    due_targets.assign(1, target);
+                    if(is_bundled) {
+                        auto until = (std::max)(target + std::chrono::nanoseconds(bundle_window_ns), clock::now());
+                        while(cursor + due_targets.size() < window.size()) {
+                            auto next = scheduledTime(window[cursor + due_targets.size()]->offset_ns);
+                            if(until < next) break;
+                            due_targets.push_back(next);
+                        }
+                    }
+
+                    lock.unlock();
+                    while(clock::now() < target) std::this_thread::yield();
+                    auto dispatched_at = clock::now();
+                    {
+                        auto &&_ = std::lock_guard<decltype(dispatcher_mutex)>(dispatcher_mutex);
+                        if(bundled_sender) {
+                            for(std::size_t i = 0; i < due_targets.size(); ++i) {
+                                const auto &record = *window[cursor + i];
+                                auto &&encoded = player->getEncodedMessage(record);
+                                if(encoded.first) bundled_sender->addEncoded(record.mess.getWaitingPort(), encoded.first, encoded.second);
+                                else bundled_sender->add(record.mess);
+                            }
+                            bundled_sender->flush();
+                        } else if(dispatcher) {
+                            for(std::size_t i = 0; i < due_targets.size(); ++i) dispatcher(*window[cursor + i]);
+                        }
+                    }
+                    for(const auto &due : due_targets) {
+                        addLatency(std::chrono::duration_cast<std::chrono::nanoseconds>(dispatched_at - due).count());
+                    }
+                    lock.lock();
+                    cursor += due_targets.size();
+                }
+            }
+
+            void addLatency(std::int64_t latency_ns) {
+                auto &&_ = std::lock_guard<decltype(stats_mutex)>(stats_mutex);
+                if(stats.num_dispatched == 0) {
+                    stats.min_ns = stats.max_ns = latency_ns;
+                } else {
+                    stats.min_ns = (std::min)(stats.min_ns, latency_ns);
+                    stats.max_ns = (std::max)(stats.max_ns, latency_ns);
+                }
+                ++stats.num_dispatched;
+                stats.mean_ns += (latency_ns - stats.mean_ns) / stats.num_dispatched;
+            }
+        }; // struct PlaybackScheduler
+    }; // namespace RecordOsc
+}; // namespace ofx
+
+using ofxRecordedOscPlaybackScheduler = ofx::RecordOsc::PlaybackScheduler;
+
+#endif /* ofxRecordedOscPlaybackScheduler_h */
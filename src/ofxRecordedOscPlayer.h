@@ -9,35 +9,121 @@
 
 #include "ofxOscMessageExJsonConversion.h"
 #include "ofxRecordOscData.h"
+#include "ofxRecordOscSession.h"
+#include "ofxRecordOscAddressFilter.h"
+#include "ofxRecordOscTrack.h"
+#include "ofxRecordOscMetrics.h"
+#include "ofxRecordOscRawSocket.h"
+#include "ofxRecordOscBundledSender.h"
+#include "ofxRecordOscSequenceReader.h"
+#include "ofxRecordOscParallel.h"
 
 #include "ofxPubSubOsc.h"
 
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <cstring>
+
 namespace ofx {
     namespace RecordOsc {
+        enum class LoadMode : std::uint8_t {
+            Eager, // decode all records on setup
+            Lazy   // map file and decode records on play. only for FileFormat::Native
+        };
+
         struct Player {
             void setup(const std::string &filepath,
-                       FileFormat format = FileFormat::Json)
+                       FileFormat format = FileFormat::Json,
+                       LoadMode mode = LoadMode::Eager)
             {
-                auto &&json = RecordOsc::detail::load(filepath, format);
-                messages = json["sequence"].get<decltype(messages)>();
-                metadata = json["metadata"];
-                std::stable_sort(messages.begin(),
-                                 messages.end());
-                std::for_each(messages.cbegin(),
-                              messages.cend(),
-                              [=](const SequenceData &m) {
-                                  addresses[m.mess.getAddress()]++;
-                              });
+                clear();
+                auto loading = std::chrono::steady_clock::now();
+                load_duration_ns = 0;
+                if(mode == LoadMode::Lazy) {
+                    if(format == FileFormat::Native) {
+                        if(setupLazy(filepath)) {
+                            load_duration_ns = detail::elapsed_nanos(loading, std::chrono::steady_clock::now());
+                            return;
+                        }
+                    } else {
+                        ofLogWarning("ofxRecordedOscPlayer") << "lazy loading is supported only for Native format. " << filepath << " is loaded eagerly.";
+                    }
+                }
+                if(format == FileFormat::Native) {
+                    NativeMappedReader reader;
+                    if(reader.open(ofToDataPath(filepath, true))) {
+                        metadata = reader.metadata();
+                        decodeChunks(reader);
+                        // ids of address in file can be used as is
+                        if(3 <= reader.fileVersion()) setAddressTable(reader.dictionary().addresses);
+                    }
+                } else {
+                    // records are decoded from tokens, DOM of whole file is not built
+                    SequenceReader reader;
+                    reader.read(filepath, format, messages);
+                    metadata = reader.metadata();
+                }
+                finishEagerSetup();
+                load_duration_ns = detail::elapsed_nanos(loading, std::chrono::steady_clock::now());
             }
             
+            // opens recording split by Recorder::setSegmentRotation as one timeline.
+            // path is session directory or its manifest.json
+            bool setupSession(const std::string &path,
+                              LoadMode mode = LoadMode::Eager)
+            {
+                clear();
+                auto loading = std::chrono::steady_clock::now();
+                load_duration_ns = 0;
+                SessionManifest manifest;
+                if(!manifest.load(ofToDataPath(path, true))) return false;
+                metadata = manifest.metadata;
+                if(!manifest.finalized) {
+                    ofLogNotice("ofxRecordedOscPlayer") << "session " << path << " is not finalized. recorded segments are loaded.";
+                }
+                if(mode == LoadMode::Lazy) {
+                    if(setupLazySession(manifest)) {
+                        load_duration_ns = detail::elapsed_nanos(loading, std::chrono::steady_clock::now());
+                        return true;
+                    }
+                    clear();
+                    metadata = manifest.metadata;
+                }
+                // all segments share ids of addresses, later segment has larger dictionary
+                std::vector<std::string> table;
+                for(std::size_t i = 0; i < manifest.segments.size(); ++i) {
+                    NativeMappedReader reader;
+                    if(!reader.open(manifest.segmentPath(i))) continue;
+                    decodeChunks(reader);
+                    if(3 <= reader.fileVersion() && table.size() < reader.dictionary().addresses.size()) {
+                        table = reader.dictionary().addresses;
+                    }
+                }
+                setAddressTable(table);
+                finishEagerSetup();
+                load_duration_ns = detail::elapsed_nanos(loading, std::chrono::steady_clock::now());
+                return true;
+            }
+
+            // number of threads to decode chunks of Native file and to index records on eager loading.
+            // 0 (default) uses all cores
+            void setLoadThreads(std::size_t num_threads)
+            { load_threads = num_threads; };
+
+            std::size_t getLoadThreads() const
+            { return load_threads ? load_threads : detail::hardware_threads(); };
+
             void summary() const {
+                // lazy mode counts addresses at first time
+                if(isLazy() && address_counts.empty()) countAddresses();
                 using pair = std::pair<std::string, std::size_t>;
                 std::vector<pair> sorted;
-                sorted.reserve(addresses.size());
-                std::transform(addresses.begin(),
-                               addresses.end(),
-                               std::back_inserter(sorted),
-                               [](const pair &p) { return p; });
+                sorted.reserve(address_counts.size());
+                for(std::size_t id = 0; id < address_counts.size(); ++id) {
+                    sorted.emplace_back(address_table[id], address_counts[id]);
+                }
                 std::sort(sorted.begin(),
                           sorted.end(),
                           [](const pair &x, const pair &y) { return x.second < y.second; });
@@ -45,50 +131,692 @@ namespace ofx {
                     ofLogNotice("ofxRecordedOscPlayer") << p.first << " " << p.second;
                 }
             }
+
+            void play(double from_ms, double to_ms) const
+            { playNanos(to_nanos(from_ms), to_nanos(to_ms)); };
+
+            void play(std::string target_host, double from_ms, double to_ms) const
+            { playNanos(target_host, to_nanos(from_ms), to_nanos(to_ms)); };
+
+            void playNanos(std::int64_t from_ns, std::int64_t to_ns) const {
+                forEachInRangeNanos(from_ns, to_ns, [](const SequenceData &data) {
+                    const auto &mess = data.mess;
+                    ofxNotifyToSubscribedOsc(mess.getWaitingPort(), mess);
+                });
+            }
+
+            void playNanos(std::string target_host, std::int64_t from_ns, std::int64_t to_ns) const {
+                forEachInRangeNanos(from_ns, to_ns, [this, &target_host](const SequenceData &data) {
+                    sendMessage(target_host, data);
+                });
+            }
+
+#pragma mark filtered playback
             
-            void play(double from_ms, double to_ms) const {
-                auto from = std::lower_bound(messages.begin(),
-                                             messages.end(),
-                                             from_ms);
-                auto to = std::upper_bound(messages.begin(),
-                                           messages.end(),
-                                           to_ms);
-                for(auto it = from; it != to; ++it) {
-                    const auto &mess = it->mess;
+            // addresses can be OSC address patterns. e.g. {"/sensor/*/accel", "/note/on"}
+            void play(double from_ms, double to_ms, const std::vector<std::string> &addresses) const
+            { playNanos(to_nanos(from_ms), to_nanos(to_ms), addresses); };
+            
+            void play(std::string target_host, double from_ms, double to_ms, const std::vector<std::string> &addresses) const
+            { playNanos(target_host, to_nanos(from_ms), to_nanos(to_ms), addresses); };
+            
+            void playNanos(std::int64_t from_ns, std::int64_t to_ns, const std::vector<std::string> &addresses) const {
+                forEachInRangeNanos(from_ns, to_ns, findAddressIds(addresses), [](const SequenceData &data) {
+                    const auto &mess = data.mess;
                     ofxNotifyToSubscribedOsc(mess.getWaitingPort(), mess);
-                }
+                });
             }
             
-            void play(std::string target_host, double from_ms, double to_ms) const {
-                auto from = std::lower_bound(messages.begin(),
-                                             messages.end(),
-                                             from_ms);
-                auto to = std::upper_bound(messages.begin(),
-                                           messages.end(),
-                                           to_ms);
-                for(auto it = from; it != to; ++it) {
-                    const auto &mess = it->mess;
-                    ofxSendOsc(target_host, mess.getWaitingPort(), mess);
+            void playNanos(std::string target_host, std::int64_t from_ns, std::int64_t to_ns, const std::vector<std::string> &addresses) const {
+                forEachInRangeNanos(from_ns, to_ns, findAddressIds(addresses), [this, &target_host](const SequenceData &data) {
+                    sendMessage(target_host, data);
+                });
+            }
+            
+#pragma mark bundled network playback
+
+            // messages of range are sent to target_host:(received port) as OSC bundles,
+            // split at max_datagram_size (see setMaxDatagramSize).
+            // host is resolved and socket is opened only when target_host is changed,
+            // and all bundles of a call are sent by one sendmmsg on linux.
+            void playBundled(std::string target_host, double from_ms, double to_ms) const
+            { playBundledNanos(target_host, to_nanos(from_ms), to_nanos(to_ms)); };
+
+            void playBundled(std::string target_host, double from_ms, double to_ms, const std::vector<std::string> &addresses) const
+            { playBundledNanos(target_host, to_nanos(from_ms), to_nanos(to_ms), addresses); };
+
+            void playBundledNanos(std::string target_host, std::int64_t from_ns, std::int64_t to_ns) const {
+                if(!prepareBundledSender(target_host)) return;
+                forEachInRangeNanos(from_ns, to_ns, [this](const SequenceData &data) {
+                    addToBundle(data);
+                });
+                bundled_sender.flush();
+            }
+
+            void playBundledNanos(std::string target_host, std::int64_t from_ns, std::int64_t to_ns, const std::vector<std::string> &addresses) const {
+                if(!prepareBundledSender(target_host)) return;
+                forEachInRangeNanos(from_ns, to_ns, findAddressIds(addresses), [this](const SequenceData &data) {
+                    addToBundle(data);
+                });
+                bundled_sender.flush();
+            }
+
+            // default is 1472 (ethernet MTU without IPv4 / UDP headers)
+            void setMaxDatagramSize(std::size_t size)
+            { bundled_sender.max_datagram_size = size; };
+
+            std::size_t getMaxDatagramSize() const
+            { return bundled_sender.max_datagram_size; };
+
+            const BundledSenderStats &getBundledSenderStats() const
+            { return bundled_sender.getStats(); };
+
+#pragma mark pre-encoded playback
+
+            // with true, each record is encoded into OSC bytes once on eager loading (or now if it is loaded),
+            // and play(host, ...) / playBundled send the bytes without conversion.
+            // bytes are kept in one contiguous arena (see getPreEncodedSize). ignored in lazy mode
+            void setPreEncode(bool enabled) {
+                pre_encode = enabled;
+                if(!enabled) {
+                    clearEncodedMessages();
+                } else if(!isLazy() && !isPreEncoded()) {
+                    encodeMessages();
                 }
             }
 
-            double duration() const
-            { return messages.empty() ? 0.0 : messages.back().offset; };
+            bool isPreEncoded() const
+            { return !encoded_offsets.empty(); };
+
+            // OSC message bytes of record, {nullptr, 0} if it is not pre-encoded.
+            // record must be an element of getMessages() (e.g. passed by forEachInRangeNanos in eager mode)
+            std::pair<const std::uint8_t *, std::size_t> getEncodedMessage(const SequenceData &record) const {
+                if(encoded_offsets.empty() || messages.empty()) return {nullptr, 0};
+                std::less<const SequenceData *> before;
+                if(before(&record, messages.data()) || !before(&record, messages.data() + messages.size())) return {nullptr, 0};
+                std::size_t index = &record - messages.data();
+                return {encoded_bytes.data() + encoded_offsets[index], encoded_offsets[index + 1] - encoded_offsets[index]};
+            }
+
+            // bytes of arena of pre-encoded messages
+            std::size_t getPreEncodedSize() const
+            { return encoded_bytes.size(); };
+
+#pragma mark raw packets
             
-            double receivedFirstMessageAt() const
-            { return messages.empty() ? 0.0 : messages.front().offset; };
+            // packets recorded by Recorder::listenRaw are sent to target_host:(received port) as is.
+            // bundles are sent as bundles, messages of packets are also played by play as messages.
+            void playPackets(std::string target_host, double from_ms, double to_ms) const
+            { playPacketsNanos(target_host, to_nanos(from_ms), to_nanos(to_ms)); };
+            
+            void playPacketsNanos(std::string target_host, std::int64_t from_ns, std::int64_t to_ns) const {
+                forEachPacketInRangeNanos(from_ns, to_ns, [&](const RawPacket &packet) {
+                    packet_sender.send(target_host, packet.received_port, packet.bytes.data(), packet.bytes.size());
+                });
+            }
+            
+            // callback: void(const RawPacket &)
+            // in lazy mode, passed packet is valid only while calling callback.
+            template <typename callback_t>
+            void forEachPacketInRangeNanos(std::int64_t from_ns,
+                                           std::int64_t to_ns,
+                                           callback_t callback) const
+            {
+                if(isLazy()) {
+                    forEachSegmentInRange(from_ns, to_ns, [&](const NativeMappedReader &segment) {
+                        segment.forEachPacketInRange(from_ns, to_ns, callback);
+                    });
+                    return;
+                }
+                auto from = std::lower_bound(packets.begin(),
+                                             packets.end(),
+                                             from_ns,
+                                             [](const RawPacket &p, std::int64_t t) { return p.offset_ns < t; });
+                for(auto it = from; it != packets.end() && it->offset_ns <= to_ns; ++it) callback(*it);
+            }
+            
+            // ids in address table of addresses matched with any of patterns
+            std::vector<std::uint32_t> findAddressIds(const std::vector<std::string> &patterns) const {
+                // old file in lazy mode builds address table on counting
+                if(isLazy() && address_counts.empty()) countAddresses();
+                AddressPatternSet pattern_set;
+                for(const auto &pattern : patterns) pattern_set.add(pattern);
+                std::vector<std::uint32_t> ids;
+                for(std::size_t id = 0; id < address_table.size(); ++id) {
+                    if(pattern_set.match(address_table[id])) ids.push_back(static_cast<std::uint32_t>(id));
+                }
+                return ids;
+            }
+            
+#pragma mark columnar
+            
+            // one track per address matched with patterns (all addresses if empty), in order of address table.
+            // e.g. makeTracks({"/sensor/*/accel"}) then track.stats(0), track.resample(0, 0.01)
+            std::vector<Track> makeTracks(const std::vector<std::string> &patterns = {}) const {
+                if(isLazy() && address_counts.empty()) countAddresses();
+                std::vector<std::uint32_t> ids;
+                if(patterns.empty()) {
+                    for(std::size_t id = 0; id < address_table.size(); ++id) ids.push_back(static_cast<std::uint32_t>(id));
+                } else {
+                    ids = findAddressIds(patterns);
+                }
+                std::vector<Track> tracks(ids.size());
+                std::vector<std::size_t> track_index_of(address_table.size(), ids.size());
+                for(std::size_t i = 0; i < ids.size(); ++i) {
+                    tracks[i].address = address_table[ids[i]];
+                    track_index_of[ids[i]] = i;
+                    if(ids[i] < address_counts.size()) {
+                        tracks[i].offsets.reserve(address_counts[ids[i]]);
+                    }
+                }
+                forEachInRangeNanos(receivedFirstMessageAtNanos(), receivedLastMessageAtNanos(), ids, [&](const SequenceData &data) {
+                    auto id = data.address_id != SequenceData::unknown_address_id
+                            ? data.address_id
+                            : findAddressId(data.mess.getAddress());
+                    if(id < track_index_of.size()) tracks[track_index_of[id]].append(data);
+                });
+                return tracks;
+            }
+            
+            // writes tracks as columnar file (see ofxRecordOscTrack.h)
+            bool exportTracks(const std::string &filepath,
+                              const std::vector<std::string> &patterns = {}) const
+            { return saveTracks(ofToDataPath(filepath, true), makeTracks(patterns)); };
+            
+#pragma mark iteration
+            
+            // callback: void(const SequenceData &)
+            // in lazy mode, passed data is valid only while calling callback.
+            template <typename callback_t>
+            void forEachInRangeNanos(std::int64_t from_ns,
+                                     std::int64_t to_ns,
+                                     callback_t callback) const
+            {
+                auto started = std::chrono::steady_clock::now();
+                std::uint64_t num_records = 0;
+                iterateInRangeNanos(from_ns, to_ns, [&](const SequenceData &data) {
+                    ++num_records;
+                    callback(data);
+                });
+                recordIteration(started, num_records);
+            }
+            
+            // only records of address_ids (see findAddressIds) are passed in order of time.
+            // in eager mode, posting lists of addresses are merged,
+            // so cost is proportional to number of records of address_ids.
+            template <typename callback_t>
+            void forEachInRangeNanos(std::int64_t from_ns,
+                                     std::int64_t to_ns,
+                                     const std::vector<std::uint32_t> &address_ids,
+                                     callback_t callback) const
+            {
+                auto started = std::chrono::steady_clock::now();
+                std::uint64_t num_records = 0;
+                iterateInRangeNanos(from_ns, to_ns, address_ids, [&](const SequenceData &data) {
+                    ++num_records;
+                    callback(data);
+                });
+                recordIteration(started, num_records);
+            }
             
+#pragma mark metrics
+            
+            PlayerMetrics getMetrics() const {
+                PlayerMetrics metrics;
+                metrics.load_duration_ms = load_duration_ns / 1000000.0;
+                metrics.iterate = iterate_latency.snapshot();
+                metrics.num_iterations = metrics.iterate.count;
+                metrics.num_iterated_records = num_iterated_records.load();
+                return metrics;
+            }
+            
+            void resetMetrics() const {
+                iterate_latency.reset();
+                num_iterated_records.reset();
+            }
+            
+            double duration() const
+            { return durationNanos() / 1000000000.0; };
+
+            double receivedFirstMessageAt() const
+            { return receivedFirstMessageAtNanos() / 1000000000.0; };
+
             double receivedLastMessageAt() const
-            { return messages.empty() ? 0.0 : messages[messages.size() - 1].offset; };
+            { return receivedLastMessageAtNanos() / 1000000000.0; };
+
+            std::int64_t durationNanos() const
+            { return receivedLastMessageAtNanos(); };
+
+            std::int64_t receivedFirstMessageAtNanos() const {
+                if(isLazy()) return mapped.front()->firstOffsetNanos();
+                return messages.empty() ? 0 : messages.front().offset_ns;
+            }
+
+            std::int64_t receivedLastMessageAtNanos() const {
+                if(isLazy()) return mapped.back()->lastOffsetNanos();
+                return messages.empty() ? 0 : messages.back().offset_ns;
+            }
+
+            std::size_t numMessages() const {
+                if(!isLazy()) return messages.size();
+                std::size_t num = 0;
+                for(const auto &segment : mapped) num += static_cast<std::size_t>(segment->numRecords());
+                return num;
+            }
+
+            bool isLazy() const
+            { return !mapped.empty(); };
+
+            // empty in lazy mode
+            const std::vector<SequenceData> &getMessages() const
+            { return messages; };
+            
+            // packets recorded by Recorder::listenRaw. empty in lazy mode
+            const std::vector<RawPacket> &getPackets() const
+            { return packets; };
+
+            const Metadata &getMetadata() const
+            { return metadata; };
+            
+            // SequenceData::address_id is index of this table
+            const std::vector<std::string> &getAddressTable() const
+            { return address_table; };
             
+            std::size_t numMessagesOf(const std::string &address) const {
+                if(isLazy() && address_counts.empty()) countAddresses();
+                auto it = address_ids.find(address);
+                if(it == address_ids.end() || address_counts.size() <= it->second) return 0;
+                return address_counts[it->second];
+            }
+
         protected:
             std::vector<SequenceData> messages;
+            std::vector<RawPacket> packets; // sorted by offset. only in eager mode
+            mutable detail::raw_sender packet_sender;
+            mutable BundledSender bundled_sender;
+            // OSC bytes of messages[i] are [encoded_offsets[i], encoded_offsets[i + 1]) of encoded_bytes
+            bool pre_encode{false};
+            std::vector<std::uint8_t> encoded_bytes;
+            std::vector<std::size_t> encoded_offsets;
             Metadata metadata;
-            std::map<std::string, std::size_t> addresses;
+            // address table can grows in lazy mode with old file
+            mutable std::vector<std::string> address_table;
+            mutable std::unordered_map<std::string, std::uint32_t> address_ids;
+            // flat array indexed by address id
+            mutable std::vector<std::size_t> address_counts;
+            // indices of messages per address id. only in eager mode
+            std::vector<std::vector<std::size_t>> postings;
+            // mapped files in order of time. one file, or segments of session
+            std::vector<std::shared_ptr<NativeMappedReader>> mapped;
+            
+            std::size_t load_threads{0};
+            std::int64_t load_duration_ns{0};
+            mutable LatencyHistogram iterate_latency;
+            mutable detail::counter num_iterated_records;
+            
+            bool prepareBundledSender(const std::string &target_host) const {
+                if(bundled_sender.isSetup() && bundled_sender.getHost() == target_host) return true;
+                return bundled_sender.setup(target_host);
+            }
+            
+            void addToBundle(const SequenceData &data) const {
+                auto &&encoded = getEncodedMessage(data);
+                if(encoded.first) bundled_sender.addEncoded(data.mess.getWaitingPort(), encoded.first, encoded.second);
+                else bundled_sender.add(data.mess);
+            }
+            
+            void sendMessage(const std::string &target_host, const SequenceData &data) const {
+                auto &&encoded = getEncodedMessage(data);
+                if(encoded.first) packet_sender.send(target_host, data.mess.getWaitingPort(), encoded.first, encoded.second);
+                else ofxSendOsc(target_host, data.mess.getWaitingPort(), data.mess);
+            }
+            
+            // parts of messages are encoded concurrently, then concatenated into arena
+            void encodeMessages() {
+                auto &&bounds = detail::split_range(messages.size(), getLoadThreads());
+                const auto num_parts = bounds.size() - 1;
+                std::vector<std::vector<std::uint8_t>> part_bytes(num_parts);
+                encoded_offsets.assign(messages.size() + 1, 0);
+                detail::parallel_for(num_parts, getLoadThreads(), [&](std::size_t p) {
+                    auto &bytes = part_bytes[p];
+                    for(auto i = bounds[p]; i < bounds[p + 1]; ++i) {
+                        encoded_offsets[i] = bytes.size();
+                        detail::osc::write_message(bytes, messages[i].mess);
+                    }
+                });
+                std::vector<std::size_t> part_begin(num_parts + 1, 0);
+                for(std::size_t p = 0; p < num_parts; ++p) part_begin[p + 1] = part_begin[p] + part_bytes[p].size();
+                encoded_bytes.resize(part_begin.back());
+                detail::parallel_for(num_parts, getLoadThreads(), [&](std::size_t p) {
+                    if(!part_bytes[p].empty()) std::memcpy(encoded_bytes.data() + part_begin[p], part_bytes[p].data(), part_bytes[p].size());
+                    for(auto i = bounds[p]; i < bounds[p + 1]; ++i) encoded_offsets[i] += part_begin[p];
+                    std::vector<std::uint8_t>().swap(part_bytes[p]);
+                });
+                encoded_offsets.back() = encoded_bytes.size();
+            }
+            
+            void clearEncodedMessages() {
+                std::vector<std::uint8_t>().swap(encoded_bytes);
+                std::vector<std::size_t>().swap(encoded_offsets);
+            }
+            
+            void recordIteration(std::chrono::steady_clock::time_point started, std::uint64_t num_records) const {
+                iterate_latency.record(detail::elapsed_nanos(started, std::chrono::steady_clock::now()));
+                num_iterated_records.add(num_records);
+            }
+            
+            template <typename callback_t>
+            void iterateInRangeNanos(std::int64_t from_ns,
+                                     std::int64_t to_ns,
+                                     callback_t callback) const
+            {
+                if(isLazy()) {
+                    forEachSegmentInRange(from_ns, to_ns, [&](const NativeMappedReader &segment) {
+                        segment.forEachRecordInRange(from_ns, to_ns, callback);
+                    });
+                    return;
+                }
+                auto &&range = rangeNanos(from_ns, to_ns);
+                for(auto it = range.first; it != range.second; ++it) callback(*it);
+            }
+            
+            template <typename callback_t>
+            void iterateInRangeNanos(std::int64_t from_ns,
+                                     std::int64_t to_ns,
+                                     const std::vector<std::uint32_t> &address_ids,
+                                     callback_t callback) const
+            {
+                if(isLazy()) {
+                    std::vector<bool> accepts(address_table.size(), false);
+                    for(auto id : address_ids) if(id < accepts.size()) accepts[id] = true;
+                    auto accept = [&accepts](std::uint32_t id) { return id < accepts.size() && accepts[id]; };
+                    forEachSegmentInRange(from_ns, to_ns, [&](const NativeMappedReader &segment) {
+                        segment.forEachRecordInRange(from_ns, to_ns, [&](const SequenceData &data) {
+                            // file without dictionary can't be filtered before decoding
+                            auto id = data.address_id != SequenceData::unknown_address_id
+                                    ? data.address_id
+                                    : findAddressId(data.mess.getAddress());
+                            if(accept(id)) callback(data);
+                        }, accept);
+                    });
+                    return;
+                }
+                
+                struct cursor {
+                    const std::size_t *it;
+                    const std::size_t *end;
+                };
+                std::vector<cursor> cursors;
+                cursors.reserve(address_ids.size());
+                for(auto id : address_ids) {
+                    if(postings.size() <= id || postings[id].empty()) continue;
+                    const auto &list = postings[id];
+                    auto from = std::lower_bound(list.data(),
+                                                 list.data() + list.size(),
+                                                 from_ns,
+                                                 [this](std::size_t index, std::int64_t t) { return messages[index].offset_ns < t; });
+                    auto to = std::upper_bound(from,
+                                               list.data() + list.size(),
+                                               to_ns,
+                                               [this](std::int64_t t, std::size_t index) { return t < messages[index].offset_ns; });
+                    if(from != to) cursors.push_back({from, to});
+                }
+                // k-way merge by index of messages, same order as unfiltered playback
+                auto later = [](const cursor &x, const cursor &y) { return *y.it < *x.it; };
+                std::make_heap(cursors.begin(), cursors.end(), later);
+                while(!cursors.empty()) {
+                    std::pop_heap(cursors.begin(), cursors.end(), later);
+                    auto &c = cursors.back();
+                    callback(messages[*c.it]);
+                    if(++c.it == c.end) {
+                        cursors.pop_back();
+                    } else {
+                        std::push_heap(cursors.begin(), cursors.end(), later);
+                    }
+                }
+            }
+
+            static std::int64_t to_nanos(double sec)
+            { return std::llround(sec * 1000000000.0); };
+
+            void clear() {
+                messages.clear();
+                packets.clear();
+                address_table.clear();
+                address_ids.clear();
+                address_counts.clear();
+                postings.clear();
+                mapped.clear();
+                clearEncodedMessages();
+            }
+            
+            // chunks are decoded concurrently into their own range of messages
+            void decodeChunks(const NativeMappedReader &reader) {
+                const auto base = messages.size();
+                const auto num_chunks = reader.numChunks();
+                messages.resize(base + static_cast<std::size_t>(reader.numRecords()));
+                std::vector<std::size_t> num_decoded(num_chunks, 0);
+                std::vector<std::vector<RawPacket>> chunk_packets(num_chunks);
+                detail::parallel_for(num_chunks, getLoadThreads(), [&](std::size_t i) {
+                    auto out = messages.data() + base + reader.chunkAt(i).first_index;
+                    num_decoded[i] = reader.decodeChunk(i, out, chunk_packets[i]);
+                });
+                // gaps of skipped broken records are closed
+                auto filled = base;
+                for(std::size_t i = 0; i < num_chunks; ++i) {
+                    auto from = messages.begin() + base + reader.chunkAt(i).first_index;
+                    if(from != messages.begin() + filled) {
+                        std::move(from, from + num_decoded[i], messages.begin() + filled);
+                    }
+                    filled += num_decoded[i];
+                    packets.insert(packets.end(),
+                                   std::make_move_iterator(chunk_packets[i].begin()),
+                                   std::make_move_iterator(chunk_packets[i].end()));
+                }
+                messages.resize(filled);
+            }
+            
+            void finishEagerSetup() {
+                // recorder writes records in order of arrival,
+                // sorting is needed only for custom time or old files.
+                // sortedness is checked per part and on boundaries of parts.
+                auto &&bounds = detail::split_range(messages.size(), getLoadThreads());
+                const auto num_parts = bounds.size() - 1;
+                std::vector<char> sorted_parts(num_parts, 1);
+                detail::parallel_for(num_parts, getLoadThreads(), [&](std::size_t p) {
+                    for(auto i = bounds[p]; i < bounds[p + 1]; ++i) {
+                        messages[i].sequence = i;
+                        if(bounds[p] < i && messages[i] < messages[i - 1]) sorted_parts[p] = 0;
+                    }
+                });
+                bool sorted = true;
+                for(std::size_t p = 0; p < num_parts && sorted; ++p) {
+                    sorted = sorted_parts[p] && (p == 0 || bounds[p] == bounds[p + 1] || !(messages[bounds[p]] < messages[bounds[p] - 1]));
+                }
+                if(!sorted) {
+                    std::stable_sort(messages.begin(),
+                                     messages.end());
+                }
+                auto earlier = [](const RawPacket &x, const RawPacket &y) { return x.offset_ns < y.offset_ns; };
+                if(!std::is_sorted(packets.begin(), packets.end(), earlier)) {
+                    std::stable_sort(packets.begin(), packets.end(), earlier);
+                }
+                indexAddresses();
+                if(pre_encode) encodeMessages();
+            }
+            
+            std::shared_ptr<NativeMappedReader> openMapped(const std::string &filepath) const {
+                auto reader = std::make_shared<NativeMappedReader>();
+                if(!reader->open(filepath)) return nullptr;
+                if(!reader->isSorted()) {
+                    ofLogNotice("ofxRecordedOscPlayer") << "offsets of " << filepath << " are not sorted. file is loaded eagerly.";
+                    return nullptr;
+                }
+                reader->mappedFile().adviseSequential();
+                return reader;
+            }
+            
+            bool setupLazy(const std::string &filepath) {
+                auto &&reader = openMapped(ofToDataPath(filepath, true));
+                if(!reader) return false;
+                metadata = reader->metadata();
+                setAddressTable(reader->dictionary().addresses);
+                mapped.push_back(reader);
+                return true;
+            }
+            
+            bool setupLazySession(const SessionManifest &manifest) {
+                std::vector<std::string> table;
+                for(std::size_t i = 0; i < manifest.segments.size(); ++i) {
+                    auto &&reader = openMapped(manifest.segmentPath(i));
+                    if(!reader) return false;
+                    if(reader->numRecords() == 0) continue;
+                    // segments must be continuous timeline
+                    if(!mapped.empty() && reader->firstOffsetNanos() < mapped.back()->lastOffsetNanos()) {
+                        ofLogNotice("ofxRecordedOscPlayer") << "segments of session overlap. session is loaded eagerly.";
+                        return false;
+                    }
+                    if(table.size() < reader->dictionary().addresses.size()) table = reader->dictionary().addresses;
+                    mapped.push_back(reader);
+                }
+                if(mapped.empty()) return false;
+                setAddressTable(table);
+                return true;
+            }
+            
+            void setAddressTable(const std::vector<std::string> &table) {
+                address_table = table;
+                address_ids.clear();
+                for(std::size_t id = 0; id < address_table.size(); ++id) {
+                    address_ids.emplace(address_table[id], static_cast<std::uint32_t>(id));
+                }
+            }
+            
+            std::uint32_t internAddress(const std::string &address) const {
+                auto it = address_ids.find(address);
+                if(it != address_ids.end()) return it->second;
+                auto id = static_cast<std::uint32_t>(address_table.size());
+                address_table.push_back(address);
+                address_ids.emplace(address, id);
+                return id;
+            }
+            
+            // for lazy mode
+            void countAddresses() const {
+                std::vector<std::size_t> counts;
+                for(const auto &segment : mapped) {
+                    if(segment->countAddresses(counts)) {
+                        if(address_counts.size() < counts.size()) address_counts.resize(counts.size(), 0);
+                        for(std::size_t id = 0; id < counts.size(); ++id) address_counts[id] += counts[id];
+                        continue;
+                    }
+                    // file has no dictionary
+                    segment->forEachRecord([this](const SequenceData &m) {
+                        auto id = internAddress(m.mess.getAddress());
+                        if(address_counts.size() <= id) address_counts.resize(id + 1, 0);
+                        ++address_counts[id];
+                    });
+                }
+            }
+            
+            std::uint32_t findAddressId(const std::string &address) const {
+                auto it = address_ids.find(address);
+                return it == address_ids.end() ? SequenceData::unknown_address_id : it->second;
+            }
+            
+            // callback: void(const NativeMappedReader &)
+            template <typename callback_t>
+            void forEachSegmentInRange(std::int64_t from_ns,
+                                       std::int64_t to_ns,
+                                       callback_t callback) const
+            {
+                for(const auto &segment : mapped) {
+                    if(segment->lastOffsetNanos() < from_ns) continue;
+                    if(to_ns < segment->firstOffsetNanos()) break;
+                    callback(*segment);
+                }
+            }
+            
+            // for eager mode. messages must be sorted.
+            // histograms of address ids are counted per part and merged,
+            // then each part fills its own range of posting lists.
+            void indexAddresses() {
+                const auto num_threads = getLoadThreads();
+                auto bounds = detail::split_range(messages.size(), num_threads);
+                auto num_parts = bounds.size() - 1;
+
+                // addresses without id (e.g. Json or old Native file) in order of appearance per part
+                std::vector<std::vector<std::string>> unknown_addresses(num_parts);
+                detail::parallel_for(num_parts, num_threads, [&](std::size_t p) {
+                    std::unordered_set<std::string> seen;
+                    for(auto i = bounds[p]; i < bounds[p + 1]; ++i) {
+                        const auto &m = messages[i];
+                        if(m.address_id != SequenceData::unknown_address_id) continue;
+                        auto &&address = m.mess.getAddress();
+                        if(seen.insert(address).second) unknown_addresses[p].push_back(address);
+                    }
+                });
+                // interned in order of first appearance as same as sequential indexing
+                for(const auto &addresses : unknown_addresses) {
+                    for(const auto &address : addresses) internAddress(address);
+                }
+                // histogram per part is as large as address table
+                if(messages.size() < address_table.size() * num_parts) {
+                    bounds = {0, messages.size()};
+                    num_parts = 1;
+                }
+
+                std::vector<std::vector<std::size_t>> part_counts(num_parts);
+                detail::parallel_for(num_parts, num_threads, [&](std::size_t p) {
+                    auto &counts = part_counts[p];
+                    counts.assign(address_table.size(), 0);
+                    for(auto i = bounds[p]; i < bounds[p + 1]; ++i) {
+                        auto &m = messages[i];
+                        if(m.address_id == SequenceData::unknown_address_id) m.address_id = findAddressId(m.mess.getAddress());
+                        if(counts.size() <= m.address_id) counts.resize(m.address_id + 1, 0);
+                        ++counts[m.address_id];
+                    }
+                });
+                std::size_t num_ids = 0;
+                for(const auto &counts : part_counts) num_ids = (std::max)(num_ids, counts.size());
+                address_counts.assign(num_ids, 0);
+                // part_counts[p][id] becomes position of part p in posting list of id
+                for(auto &counts : part_counts) {
+                    counts.resize(num_ids, 0);
+                    for(std::size_t id = 0; id < num_ids; ++id) {
+                        auto count = counts[id];
+                        counts[id] = address_counts[id];
+                        address_counts[id] += count;
+                    }
+                }
+                postings.resize(num_ids);
+                for(std::size_t id = 0; id < num_ids; ++id) postings[id].resize(address_counts[id]);
+                detail::parallel_for(num_parts, num_threads, [&](std::size_t p) {
+                    auto &positions = part_counts[p];
+                    for(auto i = bounds[p]; i < bounds[p + 1]; ++i) {
+                        auto id = messages[i].address_id;
+                        postings[id][positions[id]++] = i;
+                    }
+                });
+            }
+
+            using const_iterator = std::vector<SequenceData>::const_iterator;
+            std::pair<const_iterator, const_iterator> rangeNanos(std::int64_t from_ns, std::int64_t to_ns) const {
+                auto from = std::lower_bound(messages.begin(),
+                                             messages.end(),
+                                             from_ns,
+                                             [](const SequenceData &m, std::int64_t t) { return m.offset_ns < t; });
+                auto to = std::upper_bound(from,
+                                           messages.end(),
+                                           to_ns,
+                                           [](std::int64_t t, const SequenceData &m) { return t < m.offset_ns; });
+                return {from, to};
+            }
         }; // struct Player
     }; // namespace OscRecorder
 }; // namespace ofx
 
 using ofxRecordedOscPlayer = ofx::RecordOsc::Player;
+using ofxRecordedOscPlayerLoadMode = ofx::RecordOsc::LoadMode;
 
 #endif /* ofxRecordedOscPlayer_h */